@@ -3,6 +3,22 @@
 */
 
 #include <string>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <list>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <iterator>
 
 #if defined(_WIN32) || defined(_WIN64) // Windows
 #pragma once
@@ -21,6 +37,33 @@
 #endif
 #undef main
 
+// SDL_RenderGeometry, SDL_RenderFlush and SDL_SetTextureScaleMode are used
+#if !SDL_VERSION_ATLEAST(2, 0, 18)
+#error "SBDL needs SDL 2.0.18 or newer"
+#endif
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SBDL_SSE2
+#include <emmintrin.h>
+#endif
+
+// coroutine scripting needs C++20
+#if (__cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define SBDL_COROUTINES
+#include <coroutine>
+#endif
+#endif
+
 /**
 * represent a Sound
 * */
@@ -48,6 +91,7 @@ struct Texture {
 
 	/**
 	* width of this Texture
+	* (draw functions use the size of a reloaded file for a managed Texture, this field keeps the size at load)
 	* */
 	int width;
 
@@ -55,6 +99,30 @@ struct Texture {
 	* height of this Texture
 	* */
 	int height;
+
+	/**
+	* index of the managed entry behind this Texture (-1 if it is not managed)
+	* don't use it directly in your code
+	*/
+	int managedIndex = -1;
+
+	/**
+	* generation of the managed entry when this Texture is made, a Texture of a freed entry is not drawn
+	* don't use it directly in your code
+	*/
+	Uint32 managedGeneration = 0;
+
+	/**
+	* index of the streaming entry behind this Texture (-1 if it is not streaming)
+	* don't use it directly in your code
+	*/
+	int streamingIndex = -1;
+
+	/**
+	* true if colors of this Texture are premultiplied by alpha
+	* don't use it directly in your code
+	*/
+	bool premultiplied = false;
 };
 
 namespace SBDL {
@@ -68,6 +136,313 @@ namespace SBDL {
 		*/
 		bool running = true;
 
+		/**
+		* true after SDL is released at exit of program
+		*/
+		bool quitted = false;
+
+		/**
+		* number of frames (calls of updateEvents) since start
+		*/
+		Uint64 frameNumber = 0;
+
+		/**
+		* hierarchical timer wheel: timers are put in slots by their expiry time, far timers are put in
+		* coarse levels and move to finer levels when their time comes near
+		* adding and canceling a timer is O(1), and advancing only visits slots which are reached
+		*/
+		class TimerWheel {
+		public:
+			/**
+			* @param wheel number of this wheel which is put in ids of its timers (0 or 1)
+			*/
+			explicit TimerWheel(Uint32 wheel) : wheel(wheel) {
+				for (int level = 0; level < levels; level++)
+					slots[level].assign(size_t(1) << bits[level], -1);
+			}
+
+			/**
+			* add a timer
+			* @param now current time
+			* @param delay time until first call of callback
+			* @param interval time between calls (0 for one-shot timers)
+			* @param callback the function
+			* @return id of timer
+			*/
+			Uint64 add(Uint64 now, Uint32 delay, Uint32 interval, std::function<void()> &&callback) {
+				if (linked == 0 && !firing)
+					next = now;
+				int index;
+				if (freeNodes.empty()) {
+					index = int(nodes.size());
+					nodes.emplace_back();
+				}
+				else {
+					index = freeNodes.back();
+					freeNodes.pop_back();
+				}
+				TimerNode &node = nodes[index];
+				node.callback = std::move(callback);
+				node.expiry = now + std::max(Uint32(1), delay);
+				node.interval = interval;
+				link(index);
+				return Uint64(node.generation) << 32 | Uint64(index) << 1 | wheel;
+			}
+
+			/**
+			* cancel a timer, it can be called by callbacks of timers
+			* @param id id of timer
+			* @return false if timer is finished or canceled before
+			*/
+			bool cancel(Uint64 id) {
+				Uint32 index = Uint32(id) >> 1;
+				if ((id & 1) != wheel || index >= nodes.size() || nodes[index].generation != Uint32(id >> 32))
+					return false;
+				TimerNode &node = nodes[index];
+				if (node.state == TimerState::Linked) {
+					unlink(index);
+					release(index);
+				}
+				else if (node.state == TimerState::Firing)
+					node.state = TimerState::Canceled;
+				else
+					return false;
+				return true;
+			}
+
+			/**
+			* call callbacks of timers whose time is reached, in order of their time
+			* a repeating timer is called at most once in each call of advance
+			* @param now current time
+			*/
+			void advance(Uint64 now) {
+				if (linked == 0) {
+					next = std::max(next, now + 1);
+					return;
+				}
+				target = now;
+				while (next <= now && linked > 0) {
+					size_t index = size_t(next & mask(0));
+					// move timers of coarser levels to finer levels when a level turns around
+					if (index == 0)
+						for (int level = 1; level < levels && cascade(level) == 0; level++);
+					next++;
+
+					// take the slot out before calling callbacks, so they can add and cancel timers freely
+					batch.clear();
+					for (int node = slots[0][index]; node >= 0; node = nodes[node].next)
+						batch.push_back(node);
+					for (int node : batch) {
+						nodes[node].state = TimerState::Firing;
+						linked--;
+					}
+					slots[0][index] = -1;
+					fire();
+				}
+				next = std::max(next, now + 1);
+			}
+
+		private:
+			enum class TimerState { Free, Linked, Firing, Canceled };
+
+			struct TimerNode {
+				std::function<void()> callback;
+				Uint64 expiry = 0;
+				Uint32 interval = 0;
+				Uint32 generation = 1;
+				int previous = -1, next = -1;
+				int level = 0, slot = 0;
+				TimerState state = TimerState::Free;
+			};
+
+			static const int levels = 4;
+			const int bits[levels] = { 8, 6, 6, 6 };
+			const int shifts[levels] = { 0, 8, 14, 20 };
+
+			Uint32 wheel;
+			std::vector<int> slots[levels];
+			std::vector<TimerNode> nodes;
+			std::vector<int> freeNodes;
+
+			/**
+			* the next time which is not advanced yet, and time of current advance
+			*/
+			Uint64 next = 0, target = 0;
+
+			/**
+			* number of timers in slots, true while callbacks are called, and timers which are called now
+			*/
+			int linked = 0;
+			bool firing = false;
+			std::vector<int> batch, fired;
+
+			Uint64 mask(int level) const {
+				return (Uint64(1) << bits[level]) - 1;
+			}
+
+			/**
+			* put a timer in slot of its expiry time
+			*/
+			void link(int index) {
+				TimerNode &node = nodes[index];
+				Uint64 delta = node.expiry > next ? node.expiry - next : 0;
+				int level = 0;
+				while (level < levels - 1 && delta >> (shifts[level] + bits[level]) != 0)
+					level++;
+				// timers which are further than the last level wait in it and are put again later
+				Uint64 expiry = node.expiry < next ? next : std::min(node.expiry,
+					next + (Uint64(1) << (shifts[levels - 1] + bits[levels - 1])) - 1);
+				node.level = level;
+				node.slot = int((expiry >> shifts[level]) & mask(level));
+				node.state = TimerState::Linked;
+				node.previous = -1;
+				node.next = slots[level][node.slot];
+				if (node.next >= 0)
+					nodes[node.next].previous = index;
+				slots[level][node.slot] = index;
+				linked++;
+			}
+
+			void unlink(int index) {
+				TimerNode &node = nodes[index];
+				if (node.previous >= 0)
+					nodes[node.previous].next = node.next;
+				else
+					slots[node.level][node.slot] = node.next;
+				if (node.next >= 0)
+					nodes[node.next].previous = node.previous;
+				linked--;
+			}
+
+			void release(int index) {
+				TimerNode &node = nodes[index];
+				node.callback = nullptr;
+				node.state = TimerState::Free;
+				node.generation++;
+				freeNodes.push_back(index);
+			}
+
+			/**
+			* put timers of current slot of a level in finer levels
+			* @return index of current slot of the level
+			*/
+			size_t cascade(int level) {
+				size_t index = size_t((next >> shifts[level]) & mask(level));
+				int node = slots[level][index];
+				slots[level][index] = -1;
+				while (node >= 0) {
+					int following = nodes[node].next;
+					linked--;
+					link(node);
+					node = following;
+				}
+				return index;
+			}
+
+			/**
+			* call callbacks of timers in batch, and put repeating timers again
+			*/
+			void fire() {
+				// timers are linked to head of slots, call them in the order which they are added
+				fired.swap(batch);
+				firing = true;
+				for (size_t i = fired.size(); i-- > 0;) {
+					int index = fired[i];
+					if (nodes[index].state == TimerState::Firing) {
+						// nodes may move when callback adds a timer, so callback is called from a copy
+						std::function<void()> callback = std::move(nodes[index].callback);
+						callback();
+						nodes[index].callback = std::move(callback);
+					}
+					TimerNode &node = nodes[index];
+					if (node.state == TimerState::Firing && node.interval > 0) {
+						node.expiry = std::max(node.expiry + node.interval, target + 1);
+						link(index);
+					}
+					else
+						release(index);
+				}
+				firing = false;
+			}
+		};
+
+		/**
+		* timers of frames and timers of milliseconds, they are advanced at start of each frame
+		*/
+		TimerWheel frameTimers(0), timeTimers(1);
+
+		/**
+		* call callbacks of timers which are reached (called by updateEvents)
+		*/
+		void runTimers() {
+			frameTimers.advance(frameNumber);
+			timeTimers.advance(SDL_GetTicks());
+		}
+
+#ifdef SBDL_COROUTINES
+		/**
+		* size of coroutine frames in one size class and number of size classes which are pooled
+		* larger frames are allocated from heap
+		*/
+		const size_t coroutineFrameGranularity = 64;
+		const size_t coroutineFrameClasses = 16;
+
+		/**
+		* freed coroutine frames of each size class, they are used again by new tasks
+		*/
+		std::vector<void *> freeCoroutineFrames[coroutineFrameClasses];
+
+		/**
+		* allocate memory of a coroutine frame from pool (used only by the game thread)
+		* @param size size of frame
+		*/
+		void *allocateCoroutineFrame(size_t size) {
+			size_t sizeClass = (size + coroutineFrameGranularity - 1) / coroutineFrameGranularity - 1;
+			if (sizeClass >= coroutineFrameClasses)
+				return ::operator new(size);
+			std::vector<void *> &frames = freeCoroutineFrames[sizeClass];
+			if (frames.empty()) {
+				// allocate frames in blocks, blocks are kept until exit
+				const size_t frameSize = (sizeClass + 1) * coroutineFrameGranularity, blockFrames = 32;
+				char *block = (char *)::operator new(frameSize * blockFrames);
+				for (size_t i = 0; i < blockFrames; i++)
+					frames.push_back(block + i * frameSize);
+			}
+			void *frame = frames.back();
+			frames.pop_back();
+			return frame;
+		}
+
+		/**
+		* return memory of a coroutine frame to pool
+		* @param frame the frame
+		* @param size size of frame
+		*/
+		void freeCoroutineFrame(void *frame, size_t size) {
+			size_t sizeClass = (size + coroutineFrameGranularity - 1) / coroutineFrameGranularity - 1;
+			if (sizeClass >= coroutineFrameClasses)
+				::operator delete(frame);
+			else
+				freeCoroutineFrames[sizeClass].push_back(frame);
+		}
+
+		/**
+		* tasks which wait for the next frame, and a list which is resumed now
+		*/
+		std::vector<std::coroutine_handle<>> frameWaiters, resumedWaiters;
+
+		/**
+		* resume tasks which wait for this frame (tasks which wait for a time are resumed by timers)
+		* tasks which wait for next frame again while they are resumed, are resumed in the next frame
+		*/
+		void resumeTasks() {
+			resumedWaiters.swap(frameWaiters);
+			for (std::coroutine_handle<> task : resumedWaiters)
+				task.resume();
+			resumedWaiters.clear();
+		}
+#endif
+
 		/**
 		* SDL keyboard state array size
 		*/
@@ -98,6 +473,200 @@ namespace SBDL {
 		*/
 		SDL_Renderer *renderer = nullptr;
 
+		/**
+		* number of saves which are written by background threads and number of them which failed
+		*/
+		std::atomic<int> pendingSaves(0), failedSaves(0);
+
+		/**
+		* buffers of background saves which are written, they are used again by writers, so large saves
+		* don't allocate and touch new memory each time
+		*/
+		std::mutex saveBuffersMutex;
+		std::vector<std::vector<char>> saveBuffers;
+
+		/**
+		* take a free buffer of background saves
+		* @return the buffer (an empty vector if there is no free buffer)
+		*/
+		std::vector<char> takeSaveBuffer() {
+			std::vector<char> buffer;
+			std::lock_guard<std::mutex> lock(saveBuffersMutex);
+			if (!saveBuffers.empty()) {
+				buffer.swap(saveBuffers.back());
+				saveBuffers.pop_back();
+			}
+			return buffer;
+		}
+
+		/**
+		* give a buffer of a background save back after it is written (at most two buffers are kept)
+		*/
+		void recycleSaveBuffer(std::vector<char> &buffer) {
+			std::lock_guard<std::mutex> lock(saveBuffersMutex);
+			if (saveBuffers.size() < 2) {
+				buffer.clear();
+				saveBuffers.push_back(std::vector<char>());
+				saveBuffers.back().swap(buffer);
+			}
+		}
+
+		/**
+		* true if textures which are loaded later must have premultiplied alpha
+		*/
+		bool premultiplyAlpha = false;
+
+		/**
+		* true if renderer supports blend modes which are made by SDL_ComposeCustomBlendMode
+		* the software renderer doesn't, so textures are not premultiplied there
+		*/
+		bool customBlendModes = true;
+
+		/**
+		* blend mode of textures with premultiplied alpha
+		*/
+		SDL_BlendMode premultipliedBlendMode() {
+			return SDL_ComposeCustomBlendMode(SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+				SDL_BLENDOPERATION_ADD, SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+		}
+
+		/**
+		* convert pixels for upload in one pass: replace color key with transparent pixels, apply alpha
+		* and premultiply colors by alpha
+		* @param pixels pixels in ARGB8888 format
+		* @param count number of pixels
+		* @param changeColor true if key must be replaced with transparent color
+		* @param key RGB part of color key
+		* @param alpha transparency level which is applied to all pixels
+		* @param premultiply true if colors must be premultiplied by alpha
+		* @return true if all pixels are fully opaque after conversion
+		*/
+		bool convertPixels(Uint32 *pixels, size_t count, bool changeColor, Uint32 key, Uint8 alpha,
+			bool premultiply) {
+			Uint32 alphaOfAll = 0xFF000000;
+			size_t i = 0;
+#ifdef SBDL_SSE2
+			const __m128i rgbMask = _mm_set1_epi32(0x00FFFFFF);
+			const __m128i keyVector = _mm_set1_epi32(int(key));
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i round = _mm_set1_epi16(128);
+			// multiply blue, green and red by 255 (no change) and alpha by alpha level
+			const __m128i alphaFactor = _mm_set_epi16(alpha, 255, 255, 255, alpha, 255, 255, 255);
+			const __m128i alphaLanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+			__m128i alphaVector = _mm_set1_epi32(-1);
+			for (; i + 4 <= count; i += 4) {
+				__m128i p = _mm_loadu_si128((const __m128i *)(pixels + i));
+				if (changeColor)
+					p = _mm_andnot_si128(_mm_cmpeq_epi32(_mm_and_si128(p, rgbMask), keyVector), p);
+				if (alpha != 255 || premultiply) {
+					__m128i halves[2] = { _mm_unpacklo_epi8(p, zero), _mm_unpackhi_epi8(p, zero) };
+					for (__m128i &x : halves) {
+						// x * factor / 255 with exact rounding
+						__m128i t = _mm_add_epi16(_mm_mullo_epi16(x, alphaFactor), round);
+						x = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+						if (premultiply) {
+							__m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0xFF), 0xFF);
+							a = _mm_or_si128(_mm_andnot_si128(alphaLanes, a), _mm_and_si128(alphaLanes, _mm_set1_epi16(255)));
+							t = _mm_add_epi16(_mm_mullo_epi16(x, a), round);
+							x = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+						}
+					}
+					p = _mm_packus_epi16(halves[0], halves[1]);
+				}
+				alphaVector = _mm_and_si128(alphaVector, p);
+				_mm_storeu_si128((__m128i *)(pixels + i), p);
+			}
+			Uint32 alphas[4];
+			_mm_storeu_si128((__m128i *)alphas, alphaVector);
+			alphaOfAll &= alphas[0] & alphas[1] & alphas[2] & alphas[3];
+#endif
+			for (; i < count; i++) {
+				Uint32 p = pixels[i];
+				if (changeColor && (p & 0x00FFFFFF) == key)
+					p = 0;
+				if (alpha != 255 || premultiply) {
+					Uint32 t = (p >> 24) * alpha + 128;
+					Uint32 a = (t + (t >> 8)) >> 8;
+					Uint32 channels[3] = { (p >> 16) & 0xFF, (p >> 8) & 0xFF, p & 0xFF };
+					if (premultiply)
+						for (Uint32 &c : channels) {
+							t = c * a + 128;
+							c = (t + (t >> 8)) >> 8;
+						}
+					p = (a << 24) | (channels[0] << 16) | (channels[1] << 8) | channels[2];
+				}
+				alphaOfAll &= p;
+				pixels[i] = p;
+			}
+			return (alphaOfAll & 0xFF000000) == 0xFF000000;
+		}
+
+		/**
+		* load an image from disk and convert it to ARGB8888 pixels which can be uploaded with a plain copy
+		* color key, transparency and premultiplied alpha are applied once here instead of at every draw
+		* it doesn't use the renderer, so it can be called from any thread
+		* @param path path of image
+		* @param changeColor true if given color must be replaced with transparent color
+		* @param r red color
+		* @param g green color
+		* @param b blue color
+		* @param alpha transparency level
+		* @param premultiply true if colors must be premultiplied by alpha
+		* @param opaque set to true if image has no transparent pixel
+		* @return surface in ARGB8888 format or nullptr if image can't be loaded
+		*/
+		SDL_Surface *decodeImage(const std::string &path, bool changeColor, Uint8 r, Uint8 g, Uint8 b, Uint8 alpha,
+			bool premultiply, bool &opaque) {
+			SDL_Surface *pic = IMG_Load(path.c_str());
+			if (pic == nullptr)
+				return nullptr;
+			premultiply = premultiply && customBlendModes;
+
+			// color key is compared with the color which it means in the original format (nearest palette color)
+			Uint32 key = 0;
+			if (changeColor) {
+				Uint8 keyR, keyG, keyB;
+				SDL_GetRGB(SDL_MapRGB(pic->format, r, g, b), pic->format, &keyR, &keyG, &keyB);
+				key = (Uint32(keyR) << 16) | (Uint32(keyG) << 8) | keyB;
+			}
+
+			if (pic->format->format != SDL_PIXELFORMAT_ARGB8888 || SDL_GetColorKey(pic, nullptr) == 0) {
+				SDL_Surface *converted = SDL_ConvertSurfaceFormat(pic, SDL_PIXELFORMAT_ARGB8888, 0);
+				SDL_FreeSurface(pic);
+				if (converted == nullptr)
+					return nullptr;
+				pic = converted;
+			}
+
+			opaque = true;
+			for (int y = 0; y < pic->h; y++)
+				opaque &= convertPixels((Uint32 *)((Uint8 *)pic->pixels + size_t(y) * pic->pitch), size_t(pic->w),
+					changeColor, key, alpha, premultiply);
+			return pic;
+		}
+
+		/**
+		* create a texture from a surface which is created by decodeImage
+		* @param pic the surface (it is not freed)
+		* @param opaque true if image has no transparent pixel
+		* @param premultiply true if colors of image are premultiplied by alpha
+		* @return texture which is created
+		*/
+		Texture uploadImage(SDL_Surface *pic, bool opaque, bool premultiply) {
+			Texture newTexture;
+			newTexture.underneathTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+				SDL_TEXTUREACCESS_STATIC, pic->w, pic->h);
+			SDL_UpdateTexture(newTexture.underneathTexture, nullptr, pic->pixels, pic->pitch);
+			newTexture.width = pic->w;
+			newTexture.height = pic->h;
+			newTexture.premultiplied = premultiply && customBlendModes && !opaque;
+
+			// opaque images are drawn without blending, which is much cheaper
+			SDL_SetTextureBlendMode(newTexture.underneathTexture, opaque ? SDL_BLENDMODE_NONE :
+				newTexture.premultiplied ? premultipliedBlendMode() : SDL_BLENDMODE_BLEND);
+			return newTexture;
+		}
+
 		/**
 		 * create texture with given features
 		 * @param path path of texture
@@ -106,12 +675,14 @@ namespace SBDL {
 		 * @param g green color
 		 * @param b blue color
 		 * @param alpha transparency level
+		 * @param premultiply true if colors must be premultiplied by alpha
 		 * @return texture which is created
 		 */
 		Texture loadTextureUnderneath(const std::string &path, bool changeColor, Uint8 r, Uint8 g, Uint8 b,
-			Uint8 alpha = 255) {
+			Uint8 alpha = 255, bool premultiply = false) {
 			// Check existence of image
-			SDL_Surface *pic = IMG_Load(path.c_str());
+			bool opaque;
+			SDL_Surface *pic = decodeImage(path, changeColor, r, g, b, alpha, premultiply, opaque);
 			if (pic == nullptr) {
 				const std::string message = "Missing Image file: " + path;
 				SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "SBDL load image error", message.c_str(), nullptr);
@@ -119,515 +690,6888 @@ namespace SBDL {
 			}
 
 
-			if (changeColor)
-				SDL_SetColorKey(pic, SDL_TRUE, SDL_MapRGB(pic->format, r, g, b));
-			if (alpha != 255)
-				SDL_SetSurfaceAlphaMod(pic, alpha);
-
-			Texture newTexture;
-			newTexture.underneathTexture = SDL_CreateTextureFromSurface(renderer, pic);
-			newTexture.width = pic->w;
-			newTexture.height = pic->h;
-
-			SDL_SetTextureBlendMode(newTexture.underneathTexture, SDL_BLENDMODE_BLEND);
+			Texture newTexture = uploadImage(pic, opaque, premultiply);
 			SDL_FreeSurface(pic);
 
 			return newTexture;
 		}
-	}
 
-	/**
-	* comparator of SDL_Rect
-	*/
-	bool operator==(const SDL_Rect &x, const SDL_Rect &y) {
-		return x.x == y.x && x.y == y.y && x.h == y.h && x.w == y.w;
-	}
+		/**
+		* vertices of geometry which is batched for SDL_RenderGeometry
+		*/
+		std::vector<SDL_Vertex> geometryVertices;
 
-	/**
-	* a structure which give useful information about mouse state
-	* updateEvents must be call before using this structure
-	*/
-	struct Mouse {
 		/**
-		* x position of Mouse
+		* indices of geometry which is batched for SDL_RenderGeometry
 		*/
-		int x;
+		std::vector<int> geometryIndices;
 
 		/**
-		* y position of Mouse
+		* SDL texture of batched geometry
 		*/
-		int y;
+		SDL_Texture *geometryTexture = nullptr;
 
 		/**
-		* left button state
+		* blend mode of batched geometry (SDL_BLENDMODE_INVALID for blend mode of texture)
 		*/
-		bool left;
+		SDL_BlendMode geometryBlendMode = SDL_BLENDMODE_INVALID;
 
 		/**
-		* right button state
+		* draw the batched geometry in one call and clear it
+		* must be called before any other drawing to keep the order of draws
 		*/
-		bool right;
+		void flushGeometry() {
+			if (!geometryIndices.empty()) {
+				SDL_BlendMode textureBlendMode = SDL_BLENDMODE_INVALID;
+				if (geometryTexture != nullptr && geometryBlendMode != SDL_BLENDMODE_INVALID) {
+					SDL_GetTextureBlendMode(geometryTexture, &textureBlendMode);
+					SDL_SetTextureBlendMode(geometryTexture, geometryBlendMode);
+				}
+				SDL_RenderGeometry(renderer, geometryTexture, geometryVertices.data(), int(geometryVertices.size()),
+					geometryIndices.data(), int(geometryIndices.size()));
+				if (textureBlendMode != SDL_BLENDMODE_INVALID)
+					SDL_SetTextureBlendMode(geometryTexture, textureBlendMode);
+			}
+			geometryVertices.clear();
+			geometryIndices.clear();
+		}
 
 		/**
-		* middle button state
+		* size of game coordinates (logical size of renderer)
 		*/
-		bool middle;
+		int logicalWidth = 0, logicalHeight = 0;
 
 		/**
-		* state of Mouse  < SDL_PRESSED or SDL_RELEASED >
+		* texture which the scene is drawn to when render scale is not 1, it is upscaled to window once per frame
 		*/
-		Uint8 state;
+		SDL_Texture *sceneTarget = nullptr;
+		int sceneTargetWidth = 0, sceneTargetHeight = 0;
 
 		/**
-		* button clicks
+		* scale of internal resolution, pixels of window for each unit of game coordinates, and filter of upscale
 		*/
-		Uint8 clicks;
+		float renderScale = 1, windowPixelScale = 1;
+		bool smoothUpscale = true;
 
 		/**
-		* for SDL backward compatibility
+		* size of drawing area of window in pixels, and true if it is changed in this frame
 		*/
-		Uint8 button;
+		int outputWidth = 0, outputHeight = 0;
+		bool windowResized = false;
 
 		/**
-		 * Check if Mouse clicked with given conditions.
-		 * @param button button to check <SDL_BUTTON_LEFT,SDL_BUTTON_RIGHT,SDL_BUTTON_MIDDLE>
-		 * @param clicks number of clicks
-		 * @param state sate of mouse <SDL_PRESSED,SDL_RELEASED>
-		 */
-		bool clicked(Uint8 button = SDL_BUTTON_LEFT, Uint8 clicks = 1, Uint8 state = SDL_PRESSED) {
-			return this->button == button && this->clicks == clicks && this->state == state;
+		* part of scene target which the scene is drawn to
+		*/
+		SDL_Rect sceneRect() {
+			float scale = windowPixelScale * renderScale;
+			return { 0, 0, std::max(1, int(logicalWidth * scale + 0.5f)), std::max(1, int(logicalHeight * scale + 0.5f)) };
 		}
-	} Mouse;
 
-	/**
-	* check state of program
-	* @return state of SDL
-	*/
-	bool isRunning() {
-		return Core::running;
-	}
+		/**
+		* draw next draws to scene target with game coordinates
+		*/
+		void bindSceneTarget() {
+			SDL_SetRenderTarget(renderer, sceneTarget);
+			float scale = windowPixelScale * renderScale;
+			SDL_RenderSetScale(renderer, scale, scale);
+		}
 
-	/**
-	* stop SBDL and SBDL::isRunning will return false later
-	*/
-	void stop() {
-		Core::running = false;
-	}
+		/**
+		* kind of a software post-processing effect
+		*/
+		enum class PostEffectKind { Vignette, ColorGrade, Scanlines, Bloom };
 
-	/**
-	* indicate whether a key with specific scanCode was pressed
-	* @param scanCode specific code for each keyboard button (https://wiki.libsdl.org/SDL_Scancode)
-	* @return true if specific keyboard button was pressed
-	*/
-	bool keyPressed(SDL_Scancode scanCode) {
-		return !Core::old_keystate[scanCode] && Core::keystate[scanCode];
-	}
+		/**
+		* an effect of the post-processing chain, which works on pixels of the scene after it is drawn
+		*/
+		struct PostEffect {
+			PostEffectKind kind = PostEffectKind::Vignette;
 
-	/**
-	* indicate whether a key with specific scanCode was released
-	* @param scanCode specific code for each keyboard button (https://wiki.libsdl.org/SDL_Scancode)
-	* @return true if specific keyboard button was released
-	*/
-	bool keyReleased(SDL_Scancode scanCode) {
-		return Core::old_keystate[scanCode] && !Core::keystate[scanCode];
-	}
+			/**
+			* vignette: darkness at corners and distance from center where darkening starts (0 to 1)
+			* and darkening factor of each pixel (made again when size of scene is changed)
+			*/
+			float amount = 0, radius = 0;
+			std::vector<Uint8> factors;
+			int factorsWidth = 0, factorsHeight = 0;
+			bool factorsReady = false;
 
-	/**
-	* indicate whether a key with specific scanCode is hold
-	* @param scanCode specific code for each keyboard button (https://wiki.libsdl.org/SDL_Scancode)
-	* @return true if specific keyboard button is hold
-	*/
-	bool keyHeld(SDL_Scancode scanCode) {
-		return Core::old_keystate[scanCode] && Core::keystate[scanCode];
-	}
+			/**
+			* color grade: table of each channel (blue, green, red) and saturation (64 for no change)
+			*/
+			Uint8 tables[3][256];
+			Sint16 saturation = 64;
 
-	/**
-	* initialize SDL and show a simple empty window for drawing texture on it
-	* before start using SDL functions and types, first initialize engine
-	* @param windowsTitle title of window
-	* @param windowsWidth width of window
-	* @param windowsHeight height of window
-	* @param r red color of default background
-	* @param g green color of default background
-	* @param b blue color of default background
-	*/
-	void InitEngine(const std::string &windowsTitle, int windowsWidth, int windowsHeight,
-		Uint8 r = 255, Uint8 g = 255, Uint8 b = 255) {
-		atexit(SDL_Quit); // set a SDL_Quit as exit function
-		if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+			/**
+			* scanlines: brightness of dark lines (256 for no change) and distance of lines
+			* bloom: strength of glow (256 for full strength)
+			*/
+			Uint16 scale = 256;
+			int spacing = 2;
+
+			/**
+			* bloom: brightness which glows, radius of blur in half resolution and buffers of half resolution
+			*/
+			int threshold = 0, blurRadius = 0;
+			std::vector<Uint32> bright, blurred;
+			std::vector<std::vector<Uint16>> sums;
+
+			/**
+			* time of effect in the last frame in milliseconds
+			*/
+			double time = 0;
+		};
+
+		/**
+		* effects of post-processing chain in order, pixels of scene and texture which shows processed pixels
+		*/
+		std::vector<PostEffect> postEffects;
+		std::vector<Uint32> postPixels;
+		SDL_Texture *postTexture = nullptr;
+		int postTextureWidth = 0, postTextureHeight = 0;
+
+		/**
+		* time of reading the scene and time of uploading processed pixels in the last frame (milliseconds)
+		*/
+		double postReadTime = 0, postUploadTime = 0;
+
+		/**
+		* worker threads of post-processing, each pass is split in horizontal bands and each thread does a band
+		*/
+		std::vector<std::thread> postWorkers;
+		std::mutex postMutex;
+		std::condition_variable postStart, postFinish;
+		std::function<void(int, int)> postJob;
+		Uint64 postGeneration = 0;
+		int postPending = 0;
+		bool postStopping = false;
+
+		/**
+		* stop worker threads of post-processing and wait for them (they are started again when they are needed)
+		*/
+		void stopPostWorkers() {
+			if (postWorkers.empty())
+				return;
+			{
+				std::lock_guard<std::mutex> lock(postMutex);
+				postStopping = true;
+			}
+			postStart.notify_all();
+			for (std::thread &worker : postWorkers)
+				worker.join();
+			postWorkers.clear();
+			postStopping = false;
+		}
+
+		/**
+		* start worker threads of post-processing (one thread less than cores, the game thread does a band too)
+		*/
+		void startPostWorkers() {
+			if (!postWorkers.empty())
+				return;
+			int threads = int(std::min(8u, std::max(1u, std::thread::hardware_concurrency()))) - 1;
+			// jobs which are run before start are not run by new workers
+			Uint64 generation = postGeneration;
+			for (int i = 0; i < threads; i++)
+				postWorkers.emplace_back([i, generation]() {
+				Uint64 seen = generation;
+				for (;;) {
+					std::function<void(int, int)> job;
+					{
+						std::unique_lock<std::mutex> lock(postMutex);
+						postStart.wait(lock, [&]() { return postStopping || postGeneration != seen; });
+						if (postStopping)
+							return;
+						seen = postGeneration;
+						job = postJob;
+					}
+					job(i + 1, int(postWorkers.size()) + 1);
+					std::lock_guard<std::mutex> lock(postMutex);
+					if (--postPending == 0)
+						postFinish.notify_one();
+				}
+			});
+		}
+
+		/**
+		* run a job in all bands and wait for it
+		* @param job function which gets number of band and number of bands
+		*/
+		void runPostBands(const std::function<void(int, int)> &job) {
+			if (postWorkers.empty()) {
+				job(0, 1);
+				return;
+			}
+			{
+				std::lock_guard<std::mutex> lock(postMutex);
+				postJob = job;
+				postPending = int(postWorkers.size());
+				postGeneration++;
+			}
+			postStart.notify_all();
+			job(0, int(postWorkers.size()) + 1);
+			std::unique_lock<std::mutex> lock(postMutex);
+			postFinish.wait(lock, []() { return postPending == 0; });
+		}
+
+		/**
+		* multiply channels of pixels by factors (factor + 1) / 256
+		* @param row first pixel
+		* @param factors factor of each pixel (nullptr to use constant)
+		* @param constant factor of all pixels (0 to 256) if factors is nullptr
+		* @param count number of pixels
+		*/
+		void scalePixels(Uint32 *row, const Uint8 *factors, Uint16 constant, int count) {
+			int i = 0;
+#ifdef SBDL_SSE2
+			const __m128i zero = _mm_setzero_si128(), one = _mm_set1_epi16(1), alpha = _mm_set1_epi32(int(0xFF000000));
+			__m128i low = _mm_set1_epi16(short(constant)), high = low;
+			for (; i + 4 <= count; i += 4) {
+				if (factors != nullptr) {
+					int packed;
+					std::memcpy(&packed, factors + i, 4);
+					__m128i each = _mm_add_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), one);
+					each = _mm_unpacklo_epi16(each, each);
+					low = _mm_unpacklo_epi32(each, each);
+					high = _mm_unpackhi_epi32(each, each);
+				}
+				__m128i pixels = _mm_loadu_si128((const __m128i *)(row + i));
+				__m128i a = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(pixels, zero), low), 8);
+				__m128i b = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(pixels, zero), high), 8);
+				__m128i result = _mm_or_si128(_mm_andnot_si128(alpha, _mm_packus_epi16(a, b)), _mm_and_si128(pixels, alpha));
+				_mm_storeu_si128((__m128i *)(row + i), result);
+			}
+#endif
+			for (; i < count; i++) {
+				Uint32 factor = factors != nullptr ? factors[i] + 1u : constant, pixel = row[i];
+				row[i] = ((pixel & 0xFF) * factor >> 8) | (((pixel >> 8 & 0xFF) * factor >> 8) << 8) |
+					(((pixel >> 16 & 0xFF) * factor >> 8) << 16) | (pixel & 0xFF000000);
+			}
+		}
+
+		/**
+		* move channels of pixels away from (or to) their luminance
+		* @param row first pixel
+		* @param saturation saturation * 64 (0 to 128)
+		* @param count number of pixels
+		*/
+		void saturatePixels(Uint32 *row, Sint16 saturation, int count) {
+			int i = 0;
+#ifdef SBDL_SSE2
+			// luminance is 29 * blue + 150 * green + 77 * red (ARGB8888 is BGRA in memory)
+			const __m128i zero = _mm_setzero_si128(), weights = _mm_setr_epi16(29, 150, 77, 0, 29, 150, 77, 0);
+			const __m128i factor = _mm_set1_epi16(saturation), alpha = _mm_set1_epi32(int(0xFF000000));
+			for (; i + 4 <= count; i += 4) {
+				__m128i pixels = _mm_loadu_si128((const __m128i *)(row + i));
+				__m128i halves[2] = { _mm_unpacklo_epi8(pixels, zero), _mm_unpackhi_epi8(pixels, zero) };
+				for (__m128i &half : halves) {
+					__m128i sums = _mm_madd_epi16(half, weights);
+					sums = _mm_srli_epi32(_mm_add_epi32(sums, _mm_shuffle_epi32(sums, _MM_SHUFFLE(2, 3, 0, 1))), 8);
+					__m128i luminance = _mm_packs_epi32(sums, sums);
+					luminance = _mm_unpacklo_epi16(luminance, luminance);
+					__m128i difference = _mm_mullo_epi16(_mm_sub_epi16(half, luminance), factor);
+					half = _mm_add_epi16(luminance, _mm_srai_epi16(difference, 6));
+				}
+				__m128i result = _mm_packus_epi16(halves[0], halves[1]);
+				result = _mm_or_si128(_mm_andnot_si128(alpha, result), _mm_and_si128(pixels, alpha));
+				_mm_storeu_si128((__m128i *)(row + i), result);
+			}
+#endif
+			for (; i < count; i++) {
+				Uint32 pixel = row[i], result = pixel & 0xFF000000;
+				int luminance = (29 * int(pixel & 0xFF) + 150 * int(pixel >> 8 & 0xFF) + 77 * int(pixel >> 16 & 0xFF)) >> 8;
+				for (int shift = 0; shift < 24; shift += 8) {
+					int channel = luminance + (((int(pixel >> shift & 0xFF) - luminance) * saturation) >> 6);
+					result |= Uint32(std::max(0, std::min(255, channel))) << shift;
+				}
+				row[i] = result;
+			}
+		}
+
+		/**
+		* make a row of half resolution from two rows and keep only brightness above a threshold
+		* @param top first row
+		* @param bottom second row
+		* @param output row of half resolution
+		* @param threshold brightness which is subtracted from channels
+		* @param count number of pixels of output
+		*/
+		void downsampleBright(const Uint32 *top, const Uint32 *bottom, Uint32 *output, int threshold, int count) {
+			int x = 0;
+#ifdef SBDL_SSE2
+			// alpha is removed too, so glow never changes alpha of scene
+			const __m128i subtracted = _mm_set1_epi32(int(0xFF000000 | Uint32(threshold) * 0x010101));
+			for (; x + 4 <= count; x += 4) {
+				__m128i a = _mm_avg_epu8(_mm_loadu_si128((const __m128i *)(top + 2 * x)),
+					_mm_loadu_si128((const __m128i *)(bottom + 2 * x)));
+				__m128i b = _mm_avg_epu8(_mm_loadu_si128((const __m128i *)(top + 2 * x + 4)),
+					_mm_loadu_si128((const __m128i *)(bottom + 2 * x + 4)));
+				__m128 even = _mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(2, 0, 2, 0));
+				__m128 odd = _mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(3, 1, 3, 1));
+				__m128i average = _mm_avg_epu8(_mm_castps_si128(even), _mm_castps_si128(odd));
+				_mm_storeu_si128((__m128i *)(output + x), _mm_subs_epu8(average, subtracted));
+			}
+#endif
+			for (; x < count; x++) {
+				Uint32 result = 0;
+				for (int shift = 0; shift < 24; shift += 8) {
+					int left = int((top[2 * x] >> shift & 0xFF) + (bottom[2 * x] >> shift & 0xFF) + 1) >> 1;
+					int right = int((top[2 * x + 1] >> shift & 0xFF) + (bottom[2 * x + 1] >> shift & 0xFF) + 1) >> 1;
+					result |= Uint32(std::max(0, ((left + right + 1) >> 1) - threshold)) << shift;
+				}
+				output[x] = result;
+			}
+		}
+
+		/**
+		* blur a row with a box of 2 * radius + 1 pixels (pixels of edges are repeated)
+		* sums of channels are kept in 16 bits, so the box is at most 257 pixels
+		* @param input the row
+		* @param output blurred row
+		* @param radius radius of box
+		* @param count number of pixels
+		*/
+		void blurRow(const Uint32 *input, Uint32 *output, int radius, int count) {
+			const Uint16 inverse = Uint16((65536 + 2 * radius) / (2 * radius + 1));
+#ifdef SBDL_SSE2
+			const __m128i zero = _mm_setzero_si128(), factor = _mm_set1_epi16(short(inverse));
+			__m128i sum = zero;
+			for (int x = -radius - 1; x < radius; x++)
+				sum = _mm_add_epi16(sum, _mm_unpacklo_epi8(_mm_cvtsi32_si128(int(input[std::max(0, std::min(x, count - 1))])), zero));
+			for (int x = 0; x < count; x++) {
+				__m128i entering = _mm_unpacklo_epi8(_mm_cvtsi32_si128(int(input[std::min(x + radius, count - 1)])), zero);
+				__m128i leaving = _mm_unpacklo_epi8(_mm_cvtsi32_si128(int(input[std::max(0, x - radius - 1)])), zero);
+				sum = _mm_add_epi16(_mm_sub_epi16(sum, leaving), entering);
+				__m128i result = _mm_mulhi_epu16(sum, factor);
+				output[x] = Uint32(_mm_cvtsi128_si32(_mm_packus_epi16(result, result)));
+			}
+#else
+			Uint16 sums[4] = {};
+			for (int x = -radius - 1; x < radius; x++)
+				for (int c = 0; c < 4; c++)
+					sums[c] += input[std::max(0, std::min(x, count - 1))] >> (8 * c) & 0xFF;
+			for (int x = 0; x < count; x++) {
+				Uint32 entering = input[std::min(x + radius, count - 1)], leaving = input[std::max(0, x - radius - 1)], result = 0;
+				for (int c = 0; c < 4; c++) {
+					sums[c] += (entering >> (8 * c) & 0xFF) - (leaving >> (8 * c) & 0xFF);
+					result |= (Uint32(sums[c]) * inverse >> 16) << (8 * c);
+				}
+				output[x] = result;
+			}
+#endif
+		}
+
+		/**
+		* move a vertical box blur one row down: add a row to sums of columns, remove another and write averages
+		* @param entering row which enters the box
+		* @param leaving row which leaves the box
+		* @param sums sums of channels of each column
+		* @param output blurred row
+		* @param radius radius of box
+		* @param count number of pixels
+		*/
+		void blurColumns(const Uint32 *entering, const Uint32 *leaving, Uint16 *sums, Uint32 *output, int radius, int count) {
+			const Uint16 inverse = Uint16((65536 + 2 * radius) / (2 * radius + 1));
+			int x = 0;
+#ifdef SBDL_SSE2
+			const __m128i zero = _mm_setzero_si128(), factor = _mm_set1_epi16(short(inverse));
+			for (; x + 2 <= count; x += 2) {
+				__m128i sum = _mm_loadu_si128((const __m128i *)(sums + 4 * x));
+				sum = _mm_sub_epi16(sum, _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(leaving + x)), zero));
+				sum = _mm_add_epi16(sum, _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(entering + x)), zero));
+				_mm_storeu_si128((__m128i *)(sums + 4 * x), sum);
+				__m128i result = _mm_mulhi_epu16(sum, factor);
+				_mm_storel_epi64((__m128i *)(output + x), _mm_packus_epi16(result, result));
+			}
+#endif
+			for (; x < count; x++) {
+				Uint32 result = 0;
+				for (int c = 0; c < 4; c++) {
+					Uint16 &sum = sums[4 * x + c];
+					sum += (entering[x] >> (8 * c) & 0xFF) - (leaving[x] >> (8 * c) & 0xFF);
+					result |= (Uint32(sum) * inverse >> 16) << (8 * c);
+				}
+				output[x] = result;
+			}
+		}
+
+		/**
+		* add glow of half resolution to pixels of a row
+		* @param row first pixel
+		* @param glow first pixel of row of glow
+		* @param strength strength of glow (0 to 256)
+		* @param count number of pixels
+		*/
+		void addGlow(Uint32 *row, const Uint32 *glow, Uint16 strength, int count) {
+			int i = 0;
+#ifdef SBDL_SSE2
+			const __m128i zero = _mm_setzero_si128(), factor = _mm_set1_epi16(short(strength));
+			for (; i + 4 <= count; i += 4) {
+				// each pixel of glow covers two pixels of row
+				__m128i half = _mm_loadl_epi64((const __m128i *)(glow + i / 2));
+				half = _mm_unpacklo_epi32(half, half);
+				__m128i a = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(half, zero), factor), 8);
+				__m128i b = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(half, zero), factor), 8);
+				__m128i pixels = _mm_loadu_si128((const __m128i *)(row + i));
+				_mm_storeu_si128((__m128i *)(row + i), _mm_adds_epu8(pixels, _mm_packus_epi16(a, b)));
+			}
+#endif
+			for (; i < count; i++) {
+				Uint32 light = glow[i / 2], pixel = row[i], result = pixel & 0xFF000000;
+				for (int shift = 0; shift < 24; shift += 8) {
+					Uint32 channel = (pixel >> shift & 0xFF) + ((light >> shift & 0xFF) * strength >> 8);
+					result |= std::min(255u, channel) << shift;
+				}
+				row[i] = result;
+			}
+		}
+
+		/**
+		* run a pass of an effect on rows of a band
+		* @param effect the effect
+		* @param pass number of pass
+		* @param width width of scene
+		* @param height height of scene
+		* @param band number of band
+		* @param bands number of bands
+		*/
+		void runPostPass(PostEffect &effect, int pass, int width, int height, int band, int bands) {
+			// bloom works in half resolution in its first two passes
+			const int halfWidth = std::max(1, width / 2), halfHeight = std::max(1, height / 2);
+			const int rows = effect.kind == PostEffectKind::Bloom && pass < 2 ? halfHeight : height;
+			const int first = rows * band / bands, last = rows * (band + 1) / bands;
+
+			switch (effect.kind) {
+			case PostEffectKind::Vignette:
+				for (int y = first; y < last; y++) {
+					Uint8 *factors = &effect.factors[size_t(y) * width];
+					if (!effect.factorsReady) {
+						float dy = (y + 0.5f) / height - 0.5f;
+						for (int x = 0; x < width; x++) {
+							float dx = (x + 0.5f) / width - 0.5f;
+							// distance is 1 at corners
+							float distance = std::sqrt(2 * (dx * dx + dy * dy));
+							float t = std::max(0.0f, std::min(1.0f, (distance - effect.radius) / (1 - effect.radius)));
+							factors[x] = Uint8(255 * (1 - effect.amount * t * t * (3 - 2 * t)) + 0.5f);
+						}
+					}
+					scalePixels(&postPixels[size_t(y) * width], factors, 0, width);
+				}
+				break;
+			case PostEffectKind::ColorGrade:
+				for (int y = first; y < last; y++) {
+					Uint32 *row = &postPixels[size_t(y) * width];
+					for (int x = 0; x < width; x++) {
+						Uint32 pixel = row[x];
+						row[x] = (pixel & 0xFF000000) | effect.tables[0][pixel & 0xFF] |
+							Uint32(effect.tables[1][pixel >> 8 & 0xFF]) << 8 | Uint32(effect.tables[2][pixel >> 16 & 0xFF]) << 16;
+					}
+					if (effect.saturation != 64)
+						saturatePixels(row, effect.saturation, width);
+				}
+				break;
+			case PostEffectKind::Scanlines:
+				for (int y = first; y < last; y++)
+					if (y % effect.spacing == effect.spacing - 1)
+						scalePixels(&postPixels[size_t(y) * width], nullptr, effect.scale, width);
+				break;
+			case PostEffectKind::Bloom:
+				if (pass == 0)
+					// bright parts in half resolution, then horizontal blur
+					for (int y = first; y < last; y++) {
+						Uint32 *bright = &effect.bright[size_t(y) * halfWidth];
+						downsampleBright(&postPixels[size_t(std::min(2 * y, height - 1)) * width],
+							&postPixels[size_t(std::min(2 * y + 1, height - 1)) * width], bright, effect.threshold, halfWidth);
+						blurRow(bright, &effect.blurred[size_t(y) * halfWidth], effect.blurRadius, halfWidth);
+					}
+				else if (pass == 1) {
+					// vertical blur back to bright buffer, each band starts its own sums of columns
+					const int radius = effect.blurRadius;
+					std::vector<Uint16> &sums = effect.sums[band];
+					std::fill(sums.begin(), sums.end(), 0);
+					for (int y = first - radius - 1; y < first + radius; y++) {
+						const Uint32 *row = &effect.blurred[size_t(std::max(0, std::min(y, halfHeight - 1))) * halfWidth];
+						for (int x = 0; x < halfWidth; x++)
+							for (int c = 0; c < 4; c++)
+								sums[4 * x + c] += row[x] >> (8 * c) & 0xFF;
+					}
+					for (int y = first; y < last; y++)
+						blurColumns(&effect.blurred[size_t(std::min(y + radius, halfHeight - 1)) * halfWidth],
+							&effect.blurred[size_t(std::max(0, y - radius - 1)) * halfWidth], sums.data(),
+							&effect.bright[size_t(y) * halfWidth], radius, halfWidth);
+				}
+				else
+					for (int y = first; y < last; y++)
+						addGlow(&postPixels[size_t(y) * width], &effect.bright[size_t(std::min(y / 2, halfHeight - 1)) * halfWidth],
+							effect.scale, std::min(width, 2 * halfWidth));
+				break;
+			}
+		}
+
+		/**
+		* read scene from scene target, run post-processing chain on it and upload it to a texture
+		* @param source part of scene target which has the scene
+		* @return texture which has processed scene
+		*/
+		SDL_Texture *postProcess(const SDL_Rect &source) {
+			const int width = source.w, height = source.h;
+			if (postTexture == nullptr || postTextureWidth != sceneTargetWidth || postTextureHeight != sceneTargetHeight) {
+				if (postTexture != nullptr)
+					SDL_DestroyTexture(postTexture);
+				postTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+					sceneTargetWidth, sceneTargetHeight);
+				postTextureWidth = sceneTargetWidth;
+				postTextureHeight = sceneTargetHeight;
+				if (postTexture == nullptr)
+					return sceneTarget;
+				SDL_SetTextureBlendMode(postTexture, SDL_BLENDMODE_NONE);
+				SDL_SetTextureScaleMode(postTexture, smoothUpscale ? SDL_ScaleModeLinear : SDL_ScaleModeNearest);
+			}
+
+			const double milliseconds = 1000.0 / SDL_GetPerformanceFrequency();
+			Uint64 start = SDL_GetPerformanceCounter();
+			postPixels.resize(size_t(width) * height);
+			SDL_RenderSetScale(renderer, 1, 1);
+			SDL_RenderReadPixels(renderer, &source, SDL_PIXELFORMAT_ARGB8888, postPixels.data(), width * 4);
+			postReadTime = (SDL_GetPerformanceCounter() - start) * milliseconds;
+
+			startPostWorkers();
+			const int bands = int(postWorkers.size()) + 1;
+			for (PostEffect &effect : postEffects) {
+				start = SDL_GetPerformanceCounter();
+				int passes = 1;
+				if (effect.kind == PostEffectKind::Bloom && (width < 2 || height < 2))
+					continue;
+				if (effect.kind == PostEffectKind::Vignette && (effect.factorsWidth != width || effect.factorsHeight != height)) {
+					effect.factors.resize(size_t(width) * height);
+					effect.factorsWidth = width;
+					effect.factorsHeight = height;
+					effect.factorsReady = false;
+				}
+				if (effect.kind == PostEffectKind::Bloom) {
+					passes = 3;
+					size_t half = size_t(std::max(1, width / 2)) * std::max(1, height / 2);
+					effect.bright.resize(half);
+					effect.blurred.resize(half);
+					effect.sums.resize(bands);
+					for (std::vector<Uint16> &sums : effect.sums)
+						sums.resize(4 * size_t(std::max(1, width / 2)));
+				}
+				for (int pass = 0; pass < passes; pass++)
+					runPostBands([&effect, pass, width, height](int band, int count) {
+					runPostPass(effect, pass, width, height, band, count);
+				});
+				effect.factorsReady = true;
+				effect.time = (SDL_GetPerformanceCounter() - start) * milliseconds;
+			}
+
+			start = SDL_GetPerformanceCounter();
+			SDL_UpdateTexture(postTexture, &source, postPixels.data(), width * 4);
+			postUploadTime = (SDL_GetPerformanceCounter() - start) * milliseconds;
+			return postTexture;
+		}
+
+		/**
+		* read size of window and make scene target as large as pixels of window
+		* it is called when size of window or render scale is changed
+		* the scene target is not resized when render scale is changed, only a smaller part of it is used
+		*/
+		void updateSceneTarget() {
+			flushGeometry();
+			SDL_SetRenderTarget(renderer, nullptr);
+			SDL_GetRendererOutputSize(renderer, &outputWidth, &outputHeight);
+			// post-processing needs the scene in a texture even in full resolution
+			if (renderScale == 1 && postEffects.empty()) {
+				if (sceneTarget != nullptr)
+					SDL_DestroyTexture(sceneTarget);
+				sceneTarget = nullptr;
+				return;
+			}
+
+			windowPixelScale = std::max(0.01f, std::min(float(outputWidth) / logicalWidth,
+				float(outputHeight) / logicalHeight));
+			int width = int(std::ceil(logicalWidth * windowPixelScale));
+			int height = int(std::ceil(logicalHeight * windowPixelScale));
+			if (sceneTarget == nullptr || width != sceneTargetWidth || height != sceneTargetHeight) {
+				if (sceneTarget != nullptr)
+					SDL_DestroyTexture(sceneTarget);
+				sceneTarget = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+				sceneTargetWidth = width;
+				sceneTargetHeight = height;
+				if (sceneTarget == nullptr) {
+					// renderer doesn't support render targets, draw to window directly
+					renderScale = 1;
+					return;
+				}
+				SDL_SetTextureBlendMode(sceneTarget, SDL_BLENDMODE_NONE);
+			}
+			SDL_SetTextureScaleMode(sceneTarget, smoothUpscale ? SDL_ScaleModeLinear : SDL_ScaleModeNearest);
+			bindSceneTarget();
+		}
+
+		/**
+		* add an effect to end of post-processing chain
+		* @param effect the effect
+		*/
+		void addPostEffect(const PostEffect &effect) {
+			flushGeometry();
+			postEffects.push_back(effect);
+			if (sceneTarget == nullptr)
+				updateSceneTarget();
+		}
+
+		/**
+		* upscale scene target to window
+		*/
+		void presentSceneTarget() {
+			flushGeometry();
+			SDL_Rect source = sceneRect();
+			SDL_Texture *scene = postEffects.empty() ? sceneTarget : postProcess(source);
+			SDL_SetRenderTarget(renderer, nullptr);
+			SDL_RenderClear(renderer);
+			SDL_RenderCopy(renderer, scene, &source, nullptr);
+		}
+
+		/**
+		* change resolution of scene relative to pixels of window
+		* @param scale the scale (0.25 to 1, 1 to draw to window directly)
+		* @param smooth true to upscale with linear filter
+		*/
+		void changeRenderScale(float scale, bool smooth) {
+			scale = std::max(0.25f, std::min(1.0f, scale));
+			if (scale == renderScale && smooth == smoothUpscale)
+				return;
+			flushGeometry();
+			renderScale = scale;
+			smoothUpscale = smooth;
+			if ((renderScale != 1 || !postEffects.empty()) != (sceneTarget != nullptr))
+				updateSceneTarget();
+			else if (sceneTarget != nullptr) {
+				SDL_SetTextureScaleMode(sceneTarget, smooth ? SDL_ScaleModeLinear : SDL_ScaleModeNearest);
+				if (postTexture != nullptr)
+					SDL_SetTextureScaleMode(postTexture, smooth ? SDL_ScaleModeLinear : SDL_ScaleModeNearest);
+				bindSceneTarget();
+			}
+		}
+
+		/**
+		* true after scene is lit and upscaled to window by beginHud in this frame
+		*/
+		bool hudActive = false;
+
+		/**
+		* settings of dynamic resolution controller
+		*/
+		struct DynamicResolutionSettings {
+			/**
+			* time of drawing a frame (from clearRenderScreen to updateRenderScreen) which must be kept, in milliseconds
+			*/
+			double frameBudget = 1000.0 / 60;
+
+			/**
+			* smallest and largest render scale, and change of scale at each step
+			*/
+			float minScale = 0.5f, maxScale = 1, step = 0.05f;
+
+			/**
+			* resolution is lowered when average frame time is more than lowerAbove * frameBudget and it is
+			* raised when average frame time is less than raiseBelow * frameBudget (the gap is the hysteresis)
+			*/
+			double lowerAbove = 1, raiseBelow = 0.75;
+
+			/**
+			* frames which are waited after each change, so the average shows the new resolution
+			*/
+			int settleFrames = 20;
+
+			/**
+			* weight of the last frame in average frame time (0 to 1)
+			*/
+			double smoothing = 0.1;
+		};
+
+		/**
+		* state of dynamic resolution controller
+		*/
+		bool dynamicResolution = false;
+		DynamicResolutionSettings dynamicResolutionSettings;
+		Uint64 frameStart = 0;
+		double lastFrameTime = 0, averageFrameTime = 0;
+		int framesSinceScaleChange = 0;
+		unsigned long long measuredFrames = 0, framesOverBudget = 0, scaleChanges = 0;
+
+		/**
+		* measure time of this frame and change render scale if average time is out of the hysteresis band
+		* it is called by updateRenderScreen before present, after batched draws are done
+		*/
+		void updateDynamicResolution() {
+			if (frameStart == 0)
+				return;
+			const DynamicResolutionSettings &settings = dynamicResolutionSettings;
+			// SDL batches draws until present or a change of render target, so every scale must flush them
+			// to measure the same work
+			SDL_RenderFlush(renderer);
+			lastFrameTime = (SDL_GetPerformanceCounter() - frameStart) * 1000.0 / SDL_GetPerformanceFrequency();
+			averageFrameTime = measuredFrames++ == 0 ? lastFrameTime :
+				averageFrameTime + (lastFrameTime - averageFrameTime) * settings.smoothing;
+			if (lastFrameTime > settings.frameBudget)
+				framesOverBudget++;
+			if (!dynamicResolution || ++framesSinceScaleChange < settings.settleFrames)
+				return;
+
+			float scale = renderScale;
+			if (averageFrameTime > settings.frameBudget * settings.lowerAbove)
+				scale = std::max(settings.minScale, scale - settings.step);
+			else if (averageFrameTime < settings.frameBudget * settings.raiseBelow)
+				scale = std::min(settings.maxScale, scale + settings.step);
+			if (scale != renderScale) {
+				changeRenderScale(scale, smoothUpscale);
+				framesSinceScaleChange = 0;
+				scaleChanges++;
+			}
+		}
+
+		/**
+		* texture which lights are drawn to (smaller than scene) and its size
+		*/
+		SDL_Texture *lightMap = nullptr;
+		int lightMapWidth = 0, lightMapHeight = 0;
+
+		/**
+		* texture of a light: white at center which fades to black at the circle of its radius
+		*/
+		SDL_Texture *lightFalloff = nullptr;
+		const int lightFalloffSize = 128;
+
+		/**
+		* light of places without any light
+		*/
+		SDL_Color ambientLight = { 0, 0, 0, 255 };
+
+		/**
+		* quads of lights of this frame, they are drawn to light map in one call
+		*/
+		std::vector<SDL_Vertex> lightVertices;
+		std::vector<int> lightIndices;
+
+		/**
+		* number of lights which are drawn and culled in the last frame
+		*/
+		int drawnLights = 0, culledLights = 0, queuedCulledLights = 0;
+
+		/**
+		* make texture of a light, the falloff is smooth and reaches zero at edge of circle
+		* @return false if texture can't be made
+		*/
+		bool createLightFalloff() {
+			if (lightFalloff != nullptr)
+				return true;
+			std::vector<Uint32> pixels(size_t(lightFalloffSize) * lightFalloffSize);
+			for (int y = 0; y < lightFalloffSize; y++)
+				for (int x = 0; x < lightFalloffSize; x++) {
+					float dx = (x + 0.5f) / lightFalloffSize * 2 - 1, dy = (y + 0.5f) / lightFalloffSize * 2 - 1;
+					float t = std::max(0.0f, 1 - std::sqrt(dx * dx + dy * dy));
+					Uint32 value = Uint32(255 * t * t + 0.5f);
+					pixels[size_t(y) * lightFalloffSize + x] = 0xFF000000 | value * 0x010101;
+				}
+			lightFalloff = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, lightFalloffSize,
+				lightFalloffSize);
+			if (lightFalloff == nullptr)
+				return false;
+			SDL_UpdateTexture(lightFalloff, nullptr, pixels.data(), lightFalloffSize * 4);
+			SDL_SetTextureBlendMode(lightFalloff, SDL_BLENDMODE_ADD);
+			return true;
+		}
+
+		/**
+		* draw lights of this frame to light map and multiply the scene by it
+		* next draws go to the scene again
+		*/
+		void compositeLights() {
+			flushGeometry();
+			Uint8 r, g, b, a;
+			SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+			SDL_SetRenderTarget(renderer, lightMap);
+			SDL_RenderSetScale(renderer, float(lightMapWidth) / logicalWidth, float(lightMapHeight) / logicalHeight);
+			SDL_SetRenderDrawColor(renderer, ambientLight.r, ambientLight.g, ambientLight.b, 255);
+			SDL_RenderClear(renderer);
+			if (!lightIndices.empty())
+				SDL_RenderGeometry(renderer, lightFalloff, lightVertices.data(), int(lightVertices.size()), lightIndices.data(),
+					int(lightIndices.size()));
+			SDL_SetRenderDrawColor(renderer, r, g, b, a);
+			if (sceneTarget != nullptr)
+				bindSceneTarget();
+			else
+				SDL_SetRenderTarget(renderer, nullptr);
+
+			SDL_Rect scene = { 0, 0, logicalWidth, logicalHeight };
+			SDL_RenderCopy(renderer, lightMap, nullptr, &scene);
+			drawnLights = int(lightIndices.size() / 6);
+			culledLights = queuedCulledLights;
+			queuedCulledLights = 0;
+			lightVertices.clear();
+			lightIndices.clear();
+		}
+
+		/**
+		* start batching geometry of a texture
+		* batched geometry of another texture or blend mode is drawn first
+		* @param texture SDL texture of next geometry
+		* @param blendMode blend mode of next geometry (SDL_BLENDMODE_INVALID for blend mode of texture)
+		*/
+		void batchGeometry(SDL_Texture *texture, SDL_BlendMode blendMode = SDL_BLENDMODE_INVALID) {
+			if (texture != geometryTexture || blendMode != geometryBlendMode) {
+				flushGeometry();
+				geometryTexture = texture;
+				geometryBlendMode = blendMode;
+			}
+		}
+
+		/**
+		* add a textured quad to the batched geometry
+		* @param corners corners of quad on screen (top left, top right, bottom right, bottom left)
+		* @param u1 left of quad in texture (0 to 1)
+		* @param v1 top of quad in texture (0 to 1)
+		* @param u2 right of quad in texture (0 to 1)
+		* @param v2 bottom of quad in texture (0 to 1)
+		* @param color color of vertices
+		*/
+		void pushQuad(const SDL_FPoint corners[4], float u1, float v1, float u2, float v2, SDL_Color color) {
+			int first = int(geometryVertices.size());
+			geometryVertices.push_back({ corners[0], color, { u1, v1 } });
+			geometryVertices.push_back({ corners[1], color, { u2, v1 } });
+			geometryVertices.push_back({ corners[2], color, { u2, v2 } });
+			geometryVertices.push_back({ corners[3], color, { u1, v2 } });
+			const int order[6] = { 0, 1, 2, 0, 2, 3 };
+			for (int i : order)
+				geometryIndices.push_back(first + i);
+		}
+
+		/**
+		* add an axis aligned textured quad to the batched geometry
+		* @param x1 left of quad on screen
+		* @param y1 top of quad on screen
+		* @param x2 right of quad on screen
+		* @param y2 bottom of quad on screen
+		* @see pushQuad
+		*/
+		void pushQuad(float x1, float y1, float x2, float y2, float u1, float v1, float u2, float v2,
+			SDL_Color color) {
+			const SDL_FPoint corners[4] = { { x1, y1 }, { x2, y1 }, { x2, y2 }, { x1, y2 } };
+			pushQuad(corners, u1, v1, u2, v2, color);
+		}
+
+		/**
+		* directory of converted sound cache (empty if it is disabled)
+		*/
+		std::string soundCacheDirectory;
+
+		/**
+		* memory mapped sample buffers of cached sounds with their mapping size
+		*/
+		std::map<Uint8 *, size_t> mappedSounds;
+
+		/**
+		* guards mappedSounds
+		*/
+		std::mutex soundCacheMutex;
+
+		/**
+		* header of a file in sound cache, samples follow it in the mixer format
+		*/
+		struct SoundCacheHeader {
+			char magic[4];
+			Uint32 version;
+			Uint64 sourceHash;
+			Sint32 frequency;
+			Uint16 format;
+			Uint16 channels;
+			Uint32 length;
+			Uint32 reserved;
+		};
+
+		/**
+		* FNV-1a hash of bytes
+		* @param data first byte
+		* @param size number of bytes
+		* @return 64 bits hash
+		*/
+		Uint64 hashBytes(const Uint8 *data, size_t size) {
+			Uint64 hash = 14695981039346656037ull;
+			for (size_t i = 0; i < size; i++)
+				hash = (hash ^ data[i]) * 1099511628211ull;
+			return hash;
+		}
+
+		/**
+		* read a whole file
+		* @param path path of file
+		* @param data bytes of file
+		* @return false if file can't be read
+		*/
+		bool readFile(const std::string &path, std::vector<Uint8> &data) {
+			std::ifstream file(path, std::ios::binary);
+			if (!file)
+				return false;
+			data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+			return true;
+		}
+
+		/**
+		* load samples of a cache file directly into a Mix_Chunk (memory mapped if possible)
+		* @param path path of cache file
+		* @param expected header which the file must have (length is not checked)
+		* @return sound or nullptr if cache file is missing or invalid
+		*/
+		Mix_Chunk *loadCachedSamples(const std::string &path, const SoundCacheHeader &expected) {
+			SoundCacheHeader header;
+#if defined(__linux__)
+			int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+			if (file < 0)
+				return nullptr;
+			struct stat status;
+			void *mapping = MAP_FAILED;
+			if (fstat(file, &status) == 0 && size_t(status.st_size) >= sizeof header)
+				mapping = mmap(nullptr, size_t(status.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+			close(file);
+			if (mapping == MAP_FAILED)
+				return nullptr;
+			std::memcpy(&header, mapping, sizeof header);
+			Uint8 *samples = (Uint8 *)mapping + sizeof header;
+			size_t size = size_t(status.st_size);
+#else
+			std::vector<Uint8> data;
+			if (!readFile(path, data) || data.size() < sizeof header)
+				return nullptr;
+			std::memcpy(&header, data.data(), sizeof header);
+			Uint8 *samples = (Uint8 *)SDL_malloc(data.size() - sizeof header);
+			std::memcpy(samples, data.data() + sizeof header, data.size() - sizeof header);
+			size_t size = data.size();
+#endif
+			bool valid = std::memcmp(header.magic, expected.magic, sizeof header.magic) == 0 &&
+				header.version == expected.version && header.sourceHash == expected.sourceHash &&
+				header.frequency == expected.frequency && header.format == expected.format &&
+				header.channels == expected.channels && header.length == size - sizeof header;
+			Mix_Chunk *chunk = valid ? Mix_QuickLoad_RAW(samples, header.length) : nullptr;
+#if defined(__linux__)
+			if (chunk == nullptr)
+				munmap(mapping, size);
+			else {
+				std::lock_guard<std::mutex> lock(soundCacheMutex);
+				mappedSounds[samples] = size;
+			}
+#else
+			if (chunk == nullptr)
+				SDL_free(samples);
+			else
+				chunk->allocated = 1; // Mix_FreeChunk frees samples
+#endif
+			return chunk;
+		}
+
+		/**
+		* load a sound in the format of mixer
+		* if sound cache is enabled, samples which are already converted are loaded from the cache
+		* and new ones are stored in it
+		* @param path path of sound file
+		* @return sound or nullptr if it can't be loaded
+		*/
+		Mix_Chunk *decodeSound(const std::string &path) {
+			if (soundCacheDirectory.empty())
+				return Mix_LoadWAV(path.c_str());
+
+			std::vector<Uint8> source;
+			int frequency, channels;
+			Uint16 format;
+			if (!readFile(path, source) || Mix_QuerySpec(&frequency, &format, &channels) == 0)
+				return Mix_LoadWAV(path.c_str());
+
+			SoundCacheHeader header = {};
+			std::memcpy(header.magic, "SBDS", 4);
+			header.version = 1;
+			header.sourceHash = hashBytes(source.data(), source.size());
+			header.frequency = frequency;
+			header.format = format;
+			header.channels = Uint16(channels);
+
+			// name of cache file depends on content of source and output format, so it never gets stale
+			char name[96];
+			std::snprintf(name, sizeof name, "/%016llx-%d-%x-%d.sbds", (unsigned long long)header.sourceHash,
+				frequency, unsigned(format), channels);
+			const std::string cachePath = soundCacheDirectory + name;
+			Mix_Chunk *chunk = loadCachedSamples(cachePath, header);
+			if (chunk != nullptr)
+				return chunk;
+
+			chunk = Mix_LoadWAV_RW(SDL_RWFromConstMem(source.data(), int(source.size())), 1);
+			if (chunk == nullptr)
+				return nullptr;
+			header.length = chunk->alen;
+
+			// write to a temporary file and rename it, so other loaders never see a partial file
+			const std::string temporaryPath = cachePath + "." + std::to_string(header.sourceHash ^ Uint64(
+				std::hash<std::thread::id>()(std::this_thread::get_id()))) + ".tmp";
+			std::ofstream cache(temporaryPath, std::ios::binary);
+			cache.write((const char *)&header, sizeof header);
+			cache.write((const char *)chunk->abuf, chunk->alen);
+			cache.close();
+			if (!cache || std::rename(temporaryPath.c_str(), cachePath.c_str()) != 0)
+				std::remove(temporaryPath.c_str());
+			return chunk;
+		}
+
+		/**
+		* free a sound which is loaded by decodeSound
+		* @param chunk the sound
+		*/
+		void freeChunk(Mix_Chunk *chunk) {
+#if defined(__linux__)
+			Uint8 *samples = chunk->abuf;
+			size_t size = 0;
+			{
+				std::lock_guard<std::mutex> lock(soundCacheMutex);
+				std::map<Uint8 *, size_t>::iterator mapped = mappedSounds.find(samples);
+				if (mapped != mappedSounds.end()) {
+					size = mapped->second;
+					mappedSounds.erase(mapped);
+				}
+			}
+			Mix_FreeChunk(chunk);
+			if (size != 0)
+				munmap(samples - sizeof(SoundCacheHeader), size);
+#else
+			Mix_FreeChunk(chunk);
+#endif
+		}
+
+		/**
+		* position of listener of positional sounds
+		*/
+		float listenerX = 0, listenerY = 0;
+
+		/**
+		* positional sounds closer than this distance are played with full volume
+		*/
+		float nearSoundDistance = 100;
+
+		/**
+		* positional sounds farther than this distance are silent
+		*/
+		float farSoundDistance = 1000;
+
+		/**
+		* positional sounds quieter than this volume (0 to 1) are not played
+		*/
+		float audibleSoundVolume = 0.02f;
+
+		/**
+		* true for mixer channels which have panning of a positional sound (used only by the audio thread)
+		*/
+		std::vector<bool> positionalChannels;
+
+		/**
+		* play a sound on a free mixer channel and set its panning
+		* channels which are reserved by Mix_ReserveChannels are not used, like Mix_PlayChannel(-1, ...)
+		* it runs in the audio callback, so no sample is mixed between playing and panning
+		* @param sound sound to play
+		* @param loops number of loops (-1 to play all time)
+		* @param left volume of left speaker (0 to 255)
+		* @param right volume of right speaker (0 to 255)
+		* @return channel or -1 if all channels are busy
+		*/
+		int playChannel(Mix_Chunk *sound, int loops, Uint8 left, Uint8 right) {
+			int channel = Mix_PlayChannel(-1, sound, loops);
+			if (channel < 0)
+				return -1;
+			if (positionalChannels.size() <= size_t(channel))
+				positionalChannels.resize(channel + 1, false);
+
+			bool positional = left != 255 || right != 255;
+			if (positional || positionalChannels[channel])
+				Mix_SetPanning(channel, left, right); // 255 for both removes the panning effect
+			positionalChannels[channel] = positional;
+			return channel;
+		}
+
+		/**
+		* single producer single consumer queue which never blocks or allocates
+		* one thread may push and one other thread may pop at the same time
+		*/
+		template <typename T, size_t Capacity>
+		class SpscQueue {
+		public:
+			/**
+			* add an item to the queue (producer thread only)
+			* @return false if queue is full
+			*/
+			bool push(const T &item) {
+				size_t tail = this->tail.load(std::memory_order_relaxed);
+				if (tail - head.load(std::memory_order_acquire) == Capacity)
+					return false;
+				items[tail % Capacity] = item;
+				this->tail.store(tail + 1, std::memory_order_release);
+				return true;
+			}
+
+			/**
+			* remove the oldest item from the queue (consumer thread only)
+			* @return false if queue is empty
+			*/
+			bool pop(T &item) {
+				size_t head = this->head.load(std::memory_order_relaxed);
+				if (head == tail.load(std::memory_order_acquire))
+					return false;
+				item = items[head % Capacity];
+				this->head.store(head + 1, std::memory_order_release);
+				return true;
+			}
+
+			/**
+			* number of items in the queue
+			*/
+			size_t size() const {
+				return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+			}
+
+		private:
+			T items[Capacity];
+			std::atomic<size_t> head { 0 };
+			std::atomic<size_t> tail { 0 };
+		};
+
+		/**
+		* number of buses of software mixer
+		*/
+		const int busCount = 3;
+
+		/**
+		* most frames which are mixed at once
+		*/
+		const int mixerBlockFrames = 512;
+
+		/**
+		* kind of a command which is sent to the audio thread
+		*/
+		enum class MixerCommandType {
+			Play, Stop, SetVoice, StopSound, StopAll, SetBusVolume,
+			PlayChannel, HaltChannels, ChannelVolume, MusicVolume, ReplaceSound,
+			SetBusFilter, SetBusReverb, SetDucking
+		};
+
+		/**
+		* kind of biquad filter of a bus
+		*/
+		enum class FilterKind { None, LowPass, HighPass };
+
+		/**
+		* a command which is sent from the game thread to the audio thread
+		*/
+		struct MixerCommand {
+			MixerCommandType type = MixerCommandType::Stop;
+			unsigned int voice = 0;
+			Mix_Chunk *sound = nullptr;
+			Mix_Chunk *replacement = nullptr;
+			int bus = 0;
+			float volume = 1, pan = 0, pitch = 1;
+			int loops = 0;
+			Uint8 left = 255, right = 255;
+			FilterKind filter = FilterKind::None;
+			float parameters[4] = {};
+			Uint64 sent = 0;
+		};
+
+		/**
+		* a sound which is played by the software mixer (used only by the audio thread)
+		*/
+		struct MixerVoice {
+			unsigned int id = 0;
+			bool active = false;
+			const Sint16 *samples = nullptr;
+			size_t frames = 0;
+			double position = 0;
+			double step = 1;
+			float gainLeft = 1, gainRight = 1;
+			int bus = 0;
+			int loops = 0;
+		};
+
+		/**
+		* true if software mixer is initialized
+		*/
+		std::atomic<bool> mixerEnabled(false);
+
+		/**
+		* true if commands are done by the audio thread (audio device is open)
+		* if it is false, commands are done immediately by the game thread
+		*/
+		bool audioQueueEnabled = false;
+
+		/**
+		* commands which wait for the audio thread
+		*/
+		SpscQueue<MixerCommand, 1024> mixerCommands;
+
+		/**
+		* number of commands which are sent and which are done by the audio thread
+		*/
+		unsigned long long mixerCommandsSent = 0;
+		std::atomic<unsigned long long> mixerCommandsDone(0);
+
+		/**
+		* sample rate and buffer size (in sample frames) which are requested from the audio device
+		*/
+		int audioFrequency = 22050;
+		int audioBufferSize = 640;
+
+		/**
+		* sample rate and size of one sample frame in bytes which the audio device is opened with
+		*/
+		int audioDeviceFrequency = 0;
+		int audioFrameBytes = 0;
+
+		/**
+		* buffer size of audio device in sample frames (as it is seen in callbacks, 0 before the first one)
+		* and its duration in performance counter ticks (estimated from requested size until the first callback)
+		*/
+		std::atomic<int> audioBufferFrames(0);
+		std::atomic<Uint64> audioBufferTicks(0);
+
+		/**
+		* number of buckets of audio histograms, bucket i counts values from 2^i to 2^(i+1) microseconds
+		*/
+		const int audioHistogramBuckets = 24;
+
+		/**
+		* statistics of the audio thread, they are written by the audio thread and read by the game thread
+		* times are in performance counter ticks
+		*/
+		std::atomic<unsigned long long> audioCallbacks(0), audioUnderruns(0), playedSounds(0);
+		std::atomic<Uint64> callbackTicks(0), maxCallbackTicks(0), maxCallbackInterval(0);
+		std::atomic<Uint64> latencyTicks(0), maxLatencyTicks(0);
+		std::atomic<unsigned long long> callbackHistogram[audioHistogramBuckets];
+		std::atomic<unsigned long long> latencyHistogram[audioHistogramBuckets];
+		std::atomic<int> maxAudioQueueDepth(0);
+
+		/**
+		* start time of previous audio callback (used only by the audio thread)
+		*/
+		Uint64 lastCallback = 0;
+
+		/**
+		* number of commands which can't be sent because queue is full and commands which are not done
+		* because of it (used only by the game thread)
+		*/
+		unsigned long long audioQueueFull = 0, audioCommandsDropped = 0;
+
+		/**
+		* set an atomic value to maximum of it and another value (there must be only one writer thread)
+		*/
+		template <typename T>
+		void storeMax(std::atomic<T> &target, T value) {
+			if (value > target.load(std::memory_order_relaxed))
+				target.store(value, std::memory_order_relaxed);
+		}
+
+		/**
+		* add a time to a histogram of audio statistics
+		* @param histogram the histogram
+		* @param ticks time in performance counter ticks
+		*/
+		void addToHistogram(std::atomic<unsigned long long> *histogram, Uint64 ticks) {
+			Uint64 microseconds = ticks * 1000000 / SDL_GetPerformanceFrequency();
+			int bucket = 0;
+			while (microseconds > 1 && bucket < audioHistogramBuckets - 1) {
+				microseconds >>= 1;
+				bucket++;
+			}
+			histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/**
+		* record time from sending a play command to output of its first sample (estimated)
+		* @param command the command which is done now
+		* @param now current time
+		* @param buffers number of audio buffers which play before the first sample
+		*/
+		void recordLatency(const MixerCommand &command, Uint64 now, int buffers) {
+			if (command.sent == 0 || now < command.sent)
+				return;
+			Uint64 latency = now - command.sent + buffers * audioBufferTicks.load(std::memory_order_relaxed);
+			playedSounds.fetch_add(1, std::memory_order_relaxed);
+			latencyTicks.fetch_add(latency, std::memory_order_relaxed);
+			storeMax(maxLatencyTicks, latency);
+			addToHistogram(latencyHistogram, latency);
+		}
+
+		/**
+		* record timing of an audio callback
+		* only the post-mix part is timed, SDL_mixer has mixed its channels and music before start
+		* @param start start time of post-mix hook
+		* @param end end time of post-mix hook
+		*/
+		void recordCallback(Uint64 start, Uint64 end) {
+			audioCallbacks.fetch_add(1, std::memory_order_relaxed);
+			callbackTicks.fetch_add(end - start, std::memory_order_relaxed);
+			storeMax(maxCallbackTicks, end - start);
+			addToHistogram(callbackHistogram, end - start);
+			if (lastCallback != 0) {
+				// device plays one buffer between callbacks, a later callback means it ran out of samples
+				Uint64 interval = start - lastCallback;
+				storeMax(maxCallbackInterval, interval);
+				Uint64 bufferTicks = audioBufferTicks.load(std::memory_order_relaxed);
+				if (bufferTicks != 0 && interval > bufferTicks * 3 / 2)
+					audioUnderruns.fetch_add(1, std::memory_order_relaxed);
+			}
+			lastCallback = start;
+		}
+
+		/**
+		* id of next voice of software mixer
+		*/
+		unsigned int nextVoiceId = 1;
+
+		/**
+		* voices, bus buffers and bus volumes of software mixer (used only by the audio thread)
+		*/
+		std::vector<MixerVoice> mixerVoices;
+		std::vector<float> busBuffers[busCount];
+		float busVolumes[busCount] = { 1, 1, 1 };
+
+		/**
+		* sample rate of audio device which is used by software mixer
+		*/
+		int mixerFrequency = 44100;
+
+		/**
+		* delay lengths of reverb at 44100 Hz (like Freeverb)
+		*/
+		const int reverbCombLengths[4] = { 1116, 1188, 1277, 1356 };
+		const int reverbAllpassLengths[2] = { 556, 441 };
+
+		/**
+		* effects of a bus of software mixer (used only by the audio thread)
+		* delay lines are allocated by initMixer, so the audio thread never allocates
+		*/
+		struct BusEffects {
+			FilterKind filter = FilterKind::None;
+			float b0 = 1, b1 = 0, b2 = 0, a1 = 0, a2 = 0;
+			// filter state of left and right channels (last two lanes are unused)
+			float z1[4] = {}, z2[4] = {};
+
+			float reverbWet = 0, reverbFeedback = 0, reverbDamping = 0;
+			std::vector<float> combs[4];
+			size_t combPositions[4] = {};
+			float combStores[4] = {};
+			std::vector<float> allpasses[2];
+			size_t allpassPositions[2] = {};
+		};
+		BusEffects busEffects[busCount];
+
+		/**
+		* ducking of music by sfx and voice buses (used only by the audio thread)
+		* amount is reduction of music gain, attack and release are in seconds
+		*/
+		float duckAmount = 0, duckThreshold = 0.05f, duckAttack = 0.01f, duckRelease = 0.3f;
+		float duckGain = 1;
+
+		/**
+		* volume of SDL_mixer music which is set by game and which is set after ducking
+		*/
+		int musicVolume = MIX_MAX_VOLUME, duckedMusicVolume = MIX_MAX_VOLUME;
+
+		/**
+		* set volume of SDL_mixer music with ducking gain
+		*/
+		void applyMusicVolume() {
+			int volume = int(musicVolume * duckGain + 0.5f);
+			if (volume != duckedMusicVolume) {
+				duckedMusicVolume = volume;
+				Mix_VolumeMusic(volume);
+			}
+		}
+
+		/**
+		* calculate coefficients of a biquad filter (Audio EQ Cookbook)
+		* @param effects effects of bus
+		* @param kind kind of filter
+		* @param cutoff cutoff frequency in Hz
+		* @param resonance Q of filter (0.707 for no peak)
+		*/
+		void setBusFilter(BusEffects &effects, FilterKind kind, float cutoff, float resonance) {
+			if (kind == FilterKind::None || cutoff <= 0) {
+				effects.filter = FilterKind::None;
+				return;
+			}
+			if (effects.filter == FilterKind::None)
+				for (int i = 0; i < 4; i++)
+					effects.z1[i] = effects.z2[i] = 0;
+			effects.filter = kind;
+			double omega = 2 * M_PI * std::min(double(cutoff), 0.49 * mixerFrequency) / mixerFrequency;
+			double alpha = std::sin(omega) / (2 * std::max(0.1f, resonance)), cosine = std::cos(omega);
+			double a0 = 1 + alpha;
+			double b1 = kind == FilterKind::LowPass ? 1 - cosine : -(1 + cosine);
+			effects.b0 = effects.b2 = float(std::abs(b1) / 2 / a0);
+			effects.b1 = float(b1 / a0);
+			effects.a1 = float(-2 * cosine / a0);
+			effects.a2 = float((1 - alpha) / a0);
+		}
+
+		/**
+		* add a command to the queue of the audio thread
+		* @return false if queue is full
+		*/
+		bool pushMixerCommand(const MixerCommand &command) {
+			MixerCommand stamped = command;
+			stamped.sent = SDL_GetPerformanceCounter();
+			if (!mixerCommands.push(stamped)) {
+				audioQueueFull++;
+				return false;
+			}
+			mixerCommandsSent++;
+			return true;
+		}
+
+		/**
+		* send a command of software mixer to the audio thread, it is dropped if queue is full
+		* @return false if command is dropped
+		*/
+		bool sendMixerCommand(const MixerCommand &command) {
+			if (pushMixerCommand(command))
+				return true;
+			audioCommandsDropped++;
+			return false;
+		}
+
+		/**
+		* calculate gains of left and right channels of a voice
+		*/
+		void setVoiceGains(MixerVoice &voice, float volume, float pan) {
+			pan = std::max(-1.0f, std::min(1.0f, pan));
+			voice.gainLeft = volume * std::min(1.0f, 1 - pan);
+			voice.gainRight = volume * std::min(1.0f, 1 + pan);
+		}
+
+		/**
+		* do a command in the audio thread
+		*/
+		void runMixerCommand(const MixerCommand &command) {
+			switch (command.type) {
+			case MixerCommandType::Play:
+				for (MixerVoice &voice : mixerVoices)
+					if (!voice.active) {
+						voice = MixerVoice();
+						voice.id = command.voice;
+						voice.active = command.sound->alen >= 2 * 2 * sizeof(Sint16);
+						voice.samples = (const Sint16 *)command.sound->abuf;
+						voice.frames = command.sound->alen / (2 * sizeof(Sint16));
+						voice.step = std::max(0.01f, command.pitch);
+						voice.bus = command.bus;
+						voice.loops = command.loops;
+						setVoiceGains(voice, command.volume * command.sound->volume / MIX_MAX_VOLUME, command.pan);
+						break;
+					}
+				break;
+			case MixerCommandType::Stop:
+			case MixerCommandType::SetVoice:
+				for (MixerVoice &voice : mixerVoices)
+					if (voice.active && voice.id == command.voice) {
+						if (command.type == MixerCommandType::Stop)
+							voice.active = false;
+						else
+							setVoiceGains(voice, command.volume, command.pan);
+					}
+				break;
+			case MixerCommandType::StopSound:
+				for (MixerVoice &voice : mixerVoices)
+					if (voice.samples == (const Sint16 *)command.sound->abuf)
+						voice.active = false;
+				break;
+			case MixerCommandType::StopAll:
+				for (MixerVoice &voice : mixerVoices)
+					voice.active = false;
+				break;
+			case MixerCommandType::SetBusVolume:
+				busVolumes[command.bus] = command.volume;
+				break;
+			case MixerCommandType::PlayChannel:
+				playChannel(command.sound, command.loops, command.left, command.right);
+				break;
+			case MixerCommandType::HaltChannels:
+				Mix_HaltChannel(-1);
+				break;
+			case MixerCommandType::ChannelVolume:
+				Mix_Volume(-1, int(command.volume));
+				break;
+			case MixerCommandType::MusicVolume:
+				musicVolume = int(command.volume);
+				if (mixerEnabled.load(std::memory_order_relaxed))
+					applyMusicVolume();
+				else
+					Mix_VolumeMusic(musicVolume);
+				break;
+			case MixerCommandType::SetBusFilter:
+				setBusFilter(busEffects[command.bus], command.filter, command.parameters[0], command.parameters[1]);
+				break;
+			case MixerCommandType::SetBusReverb: {
+				BusEffects &effects = busEffects[command.bus];
+				if (effects.reverbWet == 0) {
+					for (int i = 0; i < 4; i++) {
+						std::fill(effects.combs[i].begin(), effects.combs[i].end(), 0.0f);
+						effects.combStores[i] = 0;
+					}
+					for (std::vector<float> &allpass : effects.allpasses)
+						std::fill(allpass.begin(), allpass.end(), 0.0f);
+				}
+				effects.reverbWet = std::max(0.0f, command.parameters[0]);
+				effects.reverbFeedback = 0.7f + 0.28f * std::max(0.0f, std::min(1.0f, command.parameters[1]));
+				effects.reverbDamping = std::max(0.0f, std::min(0.99f, command.parameters[2]));
+				break;
+			}
+			case MixerCommandType::SetDucking:
+				duckAmount = std::max(0.0f, std::min(1.0f, command.parameters[0]));
+				duckThreshold = command.parameters[1];
+				duckAttack = std::max(0.001f, command.parameters[2]);
+				duckRelease = std::max(0.001f, command.parameters[3]);
+				break;
+			case MixerCommandType::ReplaceSound: {
+				// stop channels and voices which play old samples, then swap samples into the same Mix_Chunk
+				int channels = Mix_AllocateChannels(-1);
+				for (int channel = 0; channel < channels; channel++)
+					if (Mix_Playing(channel) && Mix_GetChunk(channel) == command.sound)
+						Mix_HaltChannel(channel);
+				for (MixerVoice &voice : mixerVoices)
+					if (voice.samples == (const Sint16 *)command.sound->abuf)
+						voice.active = false;
+				std::swap(command.sound->allocated, command.replacement->allocated);
+				std::swap(command.sound->abuf, command.replacement->abuf);
+				std::swap(command.sound->alen, command.replacement->alen);
+				break;
+			}
+			}
+		}
+
+		/**
+		* do a SDL_mixer command in the audio thread, so the game thread never waits for the audio device lock
+		* commands are done immediately if audio device is not open
+		* if queue is full (e.g. audio device is paused, so callbacks don't run), commands which only use
+		* SDL_mixer are done immediately (it locks the audio device itself) and others are dropped
+		*/
+		void sendAudioCommand(const MixerCommand &command) {
+			if (!audioQueueEnabled) {
+				runMixerCommand(command);
+				return;
+			}
+			if (pushMixerCommand(command))
+				return;
+			switch (command.type) {
+			case MixerCommandType::PlayChannel:
+				// panning of positional channels is known only by the audio thread
+				if (command.left == 255 && command.right == 255) {
+					int channel = Mix_PlayChannel(-1, command.sound, command.loops);
+					if (channel >= 0)
+						Mix_SetPanning(channel, 255, 255);
+					return;
+				}
+				break;
+			case MixerCommandType::HaltChannels:
+			case MixerCommandType::ChannelVolume:
+				runMixerCommand(command);
+				return;
+			case MixerCommandType::MusicVolume:
+				// volume of music is changed by ducking in the audio thread if software mixer is enabled
+				if (!mixerEnabled.load()) {
+					runMixerCommand(command);
+					return;
+				}
+				break;
+			default:
+				break;
+			}
+			audioCommandsDropped++;
+		}
+
+		/**
+		* a sound which is freed after the audio thread has stopped it
+		*/
+		struct DeferredSound {
+			Mix_Chunk *sound = nullptr;
+
+			/**
+			* value of mixerCommandsDone after the stop command is done (0 if it is not sent yet)
+			*/
+			unsigned long long ticket = 0;
+		};
+
+		/**
+		* sounds which wait for the audio thread before they are freed (used only by the game thread)
+		*/
+		std::vector<DeferredSound> deferredSounds;
+
+		/**
+		* free sounds which are not used by the audio thread anymore
+		* stop commands which found the queue full are sent again
+		*/
+		void freeDeferredSounds() {
+			unsigned long long done = mixerCommandsDone.load(std::memory_order_acquire);
+			size_t kept = 0;
+			for (DeferredSound &deferred : deferredSounds) {
+				if (deferred.ticket == 0) {
+					MixerCommand command;
+					command.type = MixerCommandType::StopSound;
+					command.sound = deferred.sound;
+					if (pushMixerCommand(command))
+						deferred.ticket = mixerCommandsSent;
+				}
+				if (deferred.ticket != 0 && done >= deferred.ticket)
+					freeChunk(deferred.sound);
+				else
+					deferredSounds[kept++] = deferred;
+			}
+			deferredSounds.resize(kept);
+		}
+
+		/**
+		* free a sound when commands which are sent before are done and voices which play it are stopped
+		* the game thread never waits for the audio thread
+		* @param chunk the sound
+		* @param ticket value of mixerCommandsDone after which the sound isn't used (0 to send a stop command)
+		*/
+		void freeChunkLater(Mix_Chunk *chunk, unsigned long long ticket = 0) {
+			if (!audioQueueEnabled) {
+				freeChunk(chunk);
+				return;
+			}
+			DeferredSound deferred;
+			deferred.sound = chunk;
+			deferred.ticket = ticket;
+			deferredSounds.push_back(deferred);
+			freeDeferredSounds();
+		}
+
+		/**
+		* add frames of stereo samples to a float buffer with gains
+		* @param source first sample
+		* @param output first sample of buffer
+		* @param frames number of frames
+		*/
+		void mixFrames(const Sint16 *source, float *output, int frames, float gainLeft, float gainRight) {
+			int i = 0;
+#ifdef SBDL_SSE2
+			const __m128 gains = _mm_setr_ps(gainLeft, gainRight, gainLeft, gainRight);
+			for (; i + 4 <= frames; i += 4) {
+				__m128i packed = _mm_loadu_si128((const __m128i *)(source + 2 * i));
+				__m128 low = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16));
+				__m128 high = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(packed, packed), 16));
+				_mm_storeu_ps(output + 2 * i, _mm_add_ps(_mm_loadu_ps(output + 2 * i), _mm_mul_ps(low, gains)));
+				_mm_storeu_ps(output + 2 * i + 4, _mm_add_ps(_mm_loadu_ps(output + 2 * i + 4), _mm_mul_ps(high, gains)));
+			}
+#endif
+			for (; i < frames; i++) {
+				output[2 * i] += source[2 * i] * gainLeft;
+				output[2 * i + 1] += source[2 * i + 1] * gainRight;
+			}
+		}
+
+		/**
+		* add frames of stereo samples to a float buffer with gains and linear resampling
+		* @param source first sample
+		* @param position position of first frame in source (must be less than step * frames before the last frame)
+		* @param step distance between frames in source
+		* @param output first sample of buffer
+		* @param frames number of frames
+		*/
+		void mixResampledFrames(const Sint16 *source, double position, double step, float *output, int frames,
+			float gainLeft, float gainRight) {
+			int i = 0;
+#ifdef SBDL_SSE2
+			// two stereo frames in each vector
+			const __m128 gains = _mm_setr_ps(gainLeft, gainRight, gainLeft, gainRight);
+			for (; i + 2 <= frames; i += 2) {
+				double first = position + i * step, second = first + step;
+				size_t a = size_t(first), b = size_t(second);
+				float fractionA = float(first - a), fractionB = float(second - b);
+				__m128 current = _mm_setr_ps(source[2 * a], source[2 * a + 1], source[2 * b], source[2 * b + 1]);
+				__m128 next = _mm_setr_ps(source[2 * a + 2], source[2 * a + 3], source[2 * b + 2], source[2 * b + 3]);
+				__m128 fraction = _mm_setr_ps(fractionA, fractionA, fractionB, fractionB);
+				__m128 sample = _mm_add_ps(current, _mm_mul_ps(_mm_sub_ps(next, current), fraction));
+				_mm_storeu_ps(output + 2 * i, _mm_add_ps(_mm_loadu_ps(output + 2 * i), _mm_mul_ps(sample, gains)));
+			}
+#endif
+			for (; i < frames; i++) {
+				double current = position + i * step;
+				size_t a = size_t(current);
+				float fraction = float(current - a);
+				output[2 * i] += (source[2 * a] + (source[2 * a + 2] - source[2 * a]) * fraction) * gainLeft;
+				output[2 * i + 1] += (source[2 * a + 1] + (source[2 * a + 3] - source[2 * a + 1]) * fraction) * gainRight;
+			}
+		}
+
+		/**
+		* mix a voice to the buffer of its bus
+		* @param voice the voice
+		* @param frames number of frames
+		*/
+		void mixVoice(MixerVoice &voice, int frames) {
+			float *output = busBuffers[voice.bus].data();
+			int done = 0;
+			while (done < frames && voice.active) {
+				// frames which can be read before the last frame of sound (it is needed for interpolation)
+				double last = double(voice.frames - 1);
+				double readable = std::ceil((last - voice.position) / voice.step);
+				int count = readable >= frames - done ? frames - done : int(readable);
+				if (count > 0) {
+					if (voice.step == 1 && voice.position == std::floor(voice.position))
+						mixFrames(voice.samples + 2 * size_t(voice.position), output + 2 * done, count,
+							voice.gainLeft, voice.gainRight);
+					else
+						mixResampledFrames(voice.samples, voice.position, voice.step, output + 2 * done, count,
+							voice.gainLeft, voice.gainRight);
+					voice.position += count * voice.step;
+					done += count;
+				}
+				if (voice.position >= last) {
+					if (voice.loops == 0)
+						voice.active = false;
+					else {
+						voice.position = std::max(0.0, voice.position - last);
+						if (voice.loops > 0)
+							voice.loops--;
+					}
+				}
+			}
+		}
+
+		/**
+		* filter a block of a bus with its biquad filter (transposed direct form II)
+		* left and right channels are filtered together in one vector
+		* @param effects effects of bus
+		* @param buffer stereo samples of bus
+		* @param frames number of frames
+		*/
+		void filterBus(BusEffects &effects, float *buffer, int frames) {
+#ifdef SBDL_SSE2
+			const __m128 b0 = _mm_set1_ps(effects.b0), b1 = _mm_set1_ps(effects.b1), b2 = _mm_set1_ps(effects.b2);
+			const __m128 a1 = _mm_set1_ps(effects.a1), a2 = _mm_set1_ps(effects.a2);
+			__m128 z1 = _mm_loadu_ps(effects.z1), z2 = _mm_loadu_ps(effects.z2);
+			for (int i = 0; i < frames; i++) {
+				__m128 x = _mm_castpd_ps(_mm_load_sd((const double *)(buffer + 2 * i)));
+				__m128 y = _mm_add_ps(_mm_mul_ps(b0, x), z1);
+				z1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1, x), _mm_mul_ps(a1, y)), z2);
+				z2 = _mm_sub_ps(_mm_mul_ps(b2, x), _mm_mul_ps(a2, y));
+				_mm_store_sd((double *)(buffer + 2 * i), _mm_castps_pd(y));
+			}
+			_mm_storeu_ps(effects.z1, z1);
+			_mm_storeu_ps(effects.z2, z2);
+#else
+			for (int i = 0; i < frames; i++)
+				for (int channel = 0; channel < 2; channel++) {
+					float x = buffer[2 * i + channel];
+					float y = effects.b0 * x + effects.z1[channel];
+					effects.z1[channel] = effects.b1 * x - effects.a1 * y + effects.z2[channel];
+					effects.z2[channel] = effects.b2 * x - effects.a2 * y;
+					buffer[2 * i + channel] = y;
+				}
+#endif
+		}
+
+		/**
+		* add reverb of a block to the bus (four parallel comb filters and two serial all-pass filters)
+		* the four comb filters are done together in one vector
+		* @param effects effects of bus
+		* @param buffer stereo samples of bus
+		* @param frames number of frames
+		*/
+		void reverbBus(BusEffects &effects, float *buffer, int frames) {
+			const float inputGain = 0.015f, damping = effects.reverbDamping, feedback = effects.reverbFeedback;
+			float *combs[4] = { effects.combs[0].data(), effects.combs[1].data(), effects.combs[2].data(),
+				effects.combs[3].data() };
+			size_t *positions = effects.combPositions;
+#ifdef SBDL_SSE2
+			const __m128 keep = _mm_set1_ps(1 - damping), damp = _mm_set1_ps(damping), back = _mm_set1_ps(feedback);
+			__m128 stores = _mm_loadu_ps(effects.combStores);
+#endif
+			for (int i = 0; i < frames; i++) {
+				float input = (buffer[2 * i] + buffer[2 * i + 1]) * inputGain;
+				float delayed[4], written[4];
+				for (int j = 0; j < 4; j++)
+					delayed[j] = combs[j][positions[j]];
+#ifdef SBDL_SSE2
+				stores = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(delayed), keep), _mm_mul_ps(stores, damp));
+				_mm_storeu_ps(written, _mm_add_ps(_mm_set1_ps(input), _mm_mul_ps(stores, back)));
+#else
+				for (int j = 0; j < 4; j++) {
+					effects.combStores[j] = delayed[j] * (1 - damping) + effects.combStores[j] * damping;
+					written[j] = input + effects.combStores[j] * feedback;
+				}
+#endif
+				float output = 0;
+				for (int j = 0; j < 4; j++) {
+					combs[j][positions[j]] = written[j];
+					if (++positions[j] == effects.combs[j].size())
+						positions[j] = 0;
+					output += delayed[j];
+				}
+				for (int j = 0; j < 2; j++) {
+					std::vector<float> &allpass = effects.allpasses[j];
+					size_t &position = effects.allpassPositions[j];
+					float stored = allpass[position];
+					allpass[position] = output + stored * 0.5f;
+					output = stored - output;
+					if (++position == allpass.size())
+						position = 0;
+				}
+				buffer[2 * i] += output * effects.reverbWet;
+				buffer[2 * i + 1] += output * effects.reverbWet;
+			}
+#ifdef SBDL_SSE2
+			_mm_storeu_ps(effects.combStores, stores);
+#endif
+		}
+
+		/**
+		* find the largest absolute sample of a block
+		* @param buffer samples
+		* @param samples number of samples
+		*/
+		float peakLevel(const float *buffer, int samples) {
+			float peak = 0;
+			int i = 0;
+#ifdef SBDL_SSE2
+			const __m128 sign = _mm_set1_ps(-0.0f);
+			__m128 peaks = _mm_setzero_ps();
+			for (; i + 4 <= samples; i += 4)
+				peaks = _mm_max_ps(peaks, _mm_andnot_ps(sign, _mm_loadu_ps(buffer + i)));
+			float lanes[4];
+			_mm_storeu_ps(lanes, peaks);
+			peak = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#endif
+			for (; i < samples; i++)
+				peak = std::max(peak, std::abs(buffer[i]));
+			return peak;
+		}
+
+		/**
+		* change ducking gain by level of sfx and voice buses and apply it to music
+		* gain is changed linearly through the block, so there is no click
+		* @param frames number of frames
+		*/
+		void duckMusic(int frames) {
+			const int music = 1;
+			float level = 0;
+			for (int bus = 0; bus < busCount; bus++)
+				if (bus != music)
+					level = std::max(level, peakLevel(busBuffers[bus].data(), 2 * frames) * busVolumes[bus] / 32768);
+			float target = level > duckThreshold ? 1 - duckAmount : 1;
+			float previous = duckGain;
+			if (duckGain != target) {
+				float time = target < duckGain ? duckAttack : duckRelease;
+				duckGain = target + (duckGain - target) * std::exp(-frames / (time * mixerFrequency));
+				if (std::abs(duckGain - target) < 0.001f)
+					duckGain = target;
+			}
+			if (previous == 1 && duckGain == 1)
+				return;
+
+			float *buffer = busBuffers[music].data();
+			float delta = (duckGain - previous) / frames;
+			int i = 0;
+#ifdef SBDL_SSE2
+			__m128 gains = _mm_setr_ps(previous, previous, previous + delta, previous + delta);
+			const __m128 step = _mm_set1_ps(2 * delta);
+			for (; i + 2 <= frames; i += 2) {
+				_mm_storeu_ps(buffer + 2 * i, _mm_mul_ps(_mm_loadu_ps(buffer + 2 * i), gains));
+				gains = _mm_add_ps(gains, step);
+			}
+#endif
+			for (; i < frames; i++) {
+				float gain = previous + delta * i;
+				buffer[2 * i] *= gain;
+				buffer[2 * i + 1] *= gain;
+			}
+			applyMusicVolume();
+		}
+
+		/**
+		* add mixed buses to a block of output with bus volumes and saturation
+		* @param stream output samples
+		* @param samples number of samples
+		*/
+		void writeBuses(Sint16 *stream, int samples) {
+			int i = 0;
+#ifdef SBDL_SSE2
+			for (; i + 8 <= samples; i += 8) {
+				__m128i packed = _mm_loadu_si128((const __m128i *)(stream + i));
+				__m128 low = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16));
+				__m128 high = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(packed, packed), 16));
+				for (int bus = 0; bus < busCount; bus++) {
+					const __m128 volume = _mm_set1_ps(busVolumes[bus]);
+					low = _mm_add_ps(low, _mm_mul_ps(_mm_loadu_ps(busBuffers[bus].data() + i), volume));
+					high = _mm_add_ps(high, _mm_mul_ps(_mm_loadu_ps(busBuffers[bus].data() + i + 4), volume));
+				}
+				_mm_storeu_si128((__m128i *)(stream + i), _mm_packs_epi32(_mm_cvtps_epi32(low), _mm_cvtps_epi32(high)));
+			}
+#endif
+			for (; i < samples; i++) {
+				float sample = stream[i];
+				for (int bus = 0; bus < busCount; bus++)
+					sample += busBuffers[bus][i] * busVolumes[bus];
+				stream[i] = Sint16(std::max(-32768.0f, std::min(32767.0f, sample)));
+			}
+		}
+
+		/**
+		* mix voices of software mixer and effects of buses to output in blocks
+		* @param samples output samples
+		* @param frames number of frames
+		*/
+		void mixBlocks(Sint16 *samples, int frames) {
+			for (int first = 0; first < frames; first += mixerBlockFrames) {
+				int count = std::min(mixerBlockFrames, frames - first);
+				for (std::vector<float> &buffer : busBuffers)
+					std::fill(buffer.begin(), buffer.begin() + 2 * count, 0.0f);
+				for (MixerVoice &voice : mixerVoices)
+					if (voice.active)
+						mixVoice(voice, count);
+				for (int bus = 0; bus < busCount; bus++) {
+					if (busEffects[bus].filter != FilterKind::None)
+						filterBus(busEffects[bus], busBuffers[bus].data(), count);
+					if (busEffects[bus].reverbWet > 0)
+						reverbBus(busEffects[bus], busBuffers[bus].data(), count);
+				}
+				if (duckAmount > 0 || duckGain != 1)
+					duckMusic(count);
+				writeBuses(samples + 2 * first, 2 * count);
+			}
+		}
+
+		/**
+		* do commands of game thread and mix voices of software mixer after SDL_mixer channels
+		* runs in the audio thread while SDL_mixer holds the audio device lock
+		* @param stream samples which are mixed by SDL_mixer
+		* @param length size of stream in bytes
+		*/
+		void postMix(void *, Uint8 *stream, int length) {
+			Uint64 start = SDL_GetPerformanceCounter();
+			int frames = audioFrameBytes != 0 ? length / audioFrameBytes : 0;
+			if (frames != 0 && frames != audioBufferFrames.load(std::memory_order_relaxed)) {
+				audioBufferFrames.store(frames, std::memory_order_relaxed);
+				audioBufferTicks.store(frames * SDL_GetPerformanceFrequency() / audioDeviceFrequency,
+					std::memory_order_relaxed);
+			}
+			storeMax(maxAudioQueueDepth, int(mixerCommands.size()));
+			unsigned long long done = 0;
+			for (MixerCommand command; mixerCommands.pop(command); done++) {
+				runMixerCommand(command);
+				// SDL_mixer channels are mixed before this function, so new channels start in the next buffer
+				if (command.type == MixerCommandType::PlayChannel)
+					recordLatency(command, start, 2);
+				else if (command.type == MixerCommandType::Play)
+					recordLatency(command, start, 1);
+			}
+			mixerCommandsDone.fetch_add(done, std::memory_order_release);
+			if (mixerEnabled.load(std::memory_order_acquire))
+				mixBlocks((Sint16 *)stream, length / int(2 * sizeof(Sint16)));
+			recordCallback(start, SDL_GetPerformanceCounter());
+		}
+
+		/**
+		* an asset which is reloaded when its file is changed on disk
+		*/
+		struct HotReloadAsset {
+			/**
+			* unique id of this asset
+			*/
+			unsigned int id = 0;
+
+			/**
+			* directory and name of file
+			*/
+			std::string directory, name;
+
+			/**
+			* load parameters of an image
+			*/
+			bool changeColor = false;
+			Uint8 r = 0, g = 0, b = 0, alpha = 255;
+			bool premultiply = false;
+
+			/**
+			* asset which is replaced (one of them is set)
+			*/
+			SDL_Texture *texture = nullptr;
+			int managedIndex = -1;
+			Mix_Chunk *sound = nullptr;
+		};
+
+		/**
+		* an asset which is decoded again by the watcher thread and waits for the next frame
+		*/
+		struct HotReloadResult {
+			unsigned int id = 0;
+			SDL_Surface *surface = nullptr;
+			bool opaque = false;
+			Mix_Chunk *sound = nullptr;
+		};
+
+		/**
+		* true if assets are reloaded when their files are changed
+		*/
+		bool hotReloadEnabled = false;
+
+		/**
+		* true if there are results which wait for the next frame
+		*/
+		std::atomic<bool> hotReloadReady(false);
+
+		/**
+		* guards hotReloadAssets, hotReloadResults and hotReloadWatches
+		*/
+		std::mutex hotReloadMutex;
+
+		/**
+		* assets which are watched
+		*/
+		std::vector<HotReloadAsset> hotReloadAssets;
+
+		/**
+		* decoded assets which wait for the next frame
+		*/
+		std::vector<HotReloadResult> hotReloadResults;
+
+		/**
+		* watched directories by inotify watch descriptor
+		*/
+		std::vector<std::pair<int, std::string>> hotReloadWatches;
+
+		/**
+		* inotify file descriptor (-1 if it is not initialized)
+		*/
+		int hotReloadFile = -1;
+
+		/**
+		* pipe which wakes the watcher thread to stop it
+		*/
+		int hotReloadWake[2] = { -1, -1 };
+
+		/**
+		* thread which waits for changed files
+		*/
+		std::thread hotReloadThread;
+
+		/**
+		* id of next watched asset
+		*/
+		unsigned int nextHotReloadId = 1;
+
+		/**
+		* decode assets of a changed file and queue them for the next frame
+		* runs on the watcher thread
+		* @param directory directory of file
+		* @param name name of file
+		*/
+		void decodeChangedFile(const std::string &directory, const std::string &name) {
+			std::vector<HotReloadAsset> changed;
+			{
+				std::lock_guard<std::mutex> lock(hotReloadMutex);
+				for (const HotReloadAsset &asset : hotReloadAssets)
+					if (asset.name == name && asset.directory == directory)
+						changed.push_back(asset);
+			}
+
+			const std::string path = directory + "/" + name;
+			std::vector<HotReloadResult> results;
+			for (const HotReloadAsset &asset : changed) {
+				HotReloadResult result;
+				result.id = asset.id;
+				if (asset.sound != nullptr)
+					result.sound = decodeSound(path);
+				else
+					result.surface = decodeImage(path, asset.changeColor, asset.r, asset.g, asset.b, asset.alpha,
+						asset.premultiply, result.opaque);
+				// file may be incomplete while it is written, the next event will try again
+				if (result.sound != nullptr || result.surface != nullptr)
+					results.push_back(result);
+			}
+
+			if (!results.empty()) {
+				std::lock_guard<std::mutex> lock(hotReloadMutex);
+				hotReloadResults.insert(hotReloadResults.end(), results.begin(), results.end());
+				hotReloadReady.store(true, std::memory_order_release);
+			}
+		}
+
+		/**
+		* wait for inotify events and decode changed files
+		* runs on the watcher thread until stopHotReload is called
+		*/
+		void watchFiles() {
+#if defined(__linux__)
+			alignas(inotify_event) char buffer[4096];
+			for (;;) {
+				// blocks until a file changes or the thread is woken to stop
+				pollfd files[2] = { { hotReloadFile, POLLIN, 0 }, { hotReloadWake[0], POLLIN, 0 } };
+				if (poll(files, 2, -1) < 0 || files[1].revents != 0)
+					return;
+				ssize_t length = read(hotReloadFile, buffer, sizeof buffer);
+				if (length <= 0)
+					return;
+				for (char *position = buffer; position < buffer + length;) {
+					const inotify_event *event = (const inotify_event *)position;
+					position += sizeof(inotify_event) + event->len;
+					if (event->len == 0)
+						continue;
+
+					std::string directory;
+					{
+						std::lock_guard<std::mutex> lock(hotReloadMutex);
+						for (const std::pair<int, std::string> &watch : hotReloadWatches)
+							if (watch.first == event->wd)
+								directory = watch.second;
+					}
+					if (!directory.empty())
+						decodeChangedFile(directory, event->name);
+				}
+			}
+#endif
+		}
+
+		/**
+		* stop the watcher thread and wait for it, so it never runs while globals are destroyed
+		*/
+		void stopHotReload() {
+#if defined(__linux__)
+			if (!hotReloadThread.joinable())
+				return;
+			char wake = 0;
+			if (write(hotReloadWake[1], &wake, 1) == 1)
+				hotReloadThread.join();
+			else
+				hotReloadThread.detach();
+			close(hotReloadWake[0]);
+			close(hotReloadWake[1]);
+			close(hotReloadFile);
+			hotReloadWake[0] = hotReloadWake[1] = hotReloadFile = -1;
+#endif
+		}
+
+		/**
+		* start watching the file of a loaded asset
+		* @param path path of file
+		* @param asset asset which is replaced when file changes (id, directory and name are set here)
+		*/
+		void watchAsset(const std::string &path, HotReloadAsset asset) {
+			if (!hotReloadEnabled)
+				return;
+			size_t slash = path.find_last_of("/\\");
+			asset.directory = slash == std::string::npos ? "." : path.substr(0, slash);
+			asset.name = slash == std::string::npos ? path : path.substr(slash + 1);
+
+			std::lock_guard<std::mutex> lock(hotReloadMutex);
+			asset.id = nextHotReloadId++;
+			hotReloadAssets.push_back(asset);
+#if defined(__linux__)
+			for (const std::pair<int, std::string> &watch : hotReloadWatches)
+				if (watch.second == asset.directory)
+					return;
+			// directories are watched because editors often save by replacing the file
+			int watch = inotify_add_watch(hotReloadFile, asset.directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+			if (watch >= 0)
+				hotReloadWatches.push_back({ watch, asset.directory });
+#endif
+		}
+
+		/**
+		* start watching the file of a loaded texture
+		* @param path path of image
+		* @param texture SDL texture which is replaced (or nullptr)
+		* @param managedIndex index of managed texture which is replaced (or -1)
+		* @see loadTextureUnderneath
+		*/
+		void watchTexture(const std::string &path, bool changeColor, Uint8 r, Uint8 g, Uint8 b, Uint8 alpha,
+			bool premultiply, SDL_Texture *texture, int managedIndex) {
+			HotReloadAsset asset;
+			asset.changeColor = changeColor;
+			asset.r = r;
+			asset.g = g;
+			asset.b = b;
+			asset.alpha = alpha;
+			asset.premultiply = premultiply;
+			asset.texture = texture;
+			asset.managedIndex = managedIndex;
+			watchAsset(path, asset);
+		}
+
+		/**
+		* a texture which is loaded by loadManagedTexture and can be evicted and reloaded by SBDL
+		*/
+		struct ManagedTexture {
+			/**
+			* load parameters for reloading the texture from disk
+			*/
+			std::string path;
+			bool changeColor = false;
+			Uint8 r = 0, g = 0, b = 0, alpha = 255;
+			bool premultiply = false;
+
+			/**
+			* resident SDL texture, nullptr when evicted
+			*/
+			SDL_Texture *texture = nullptr;
+
+			/**
+			* blend mode which is set by setTextureBlendMode (SDL_BLENDMODE_INVALID for default blend mode)
+			*/
+			SDL_BlendMode blendMode = SDL_BLENDMODE_INVALID;
+
+			/**
+			* true if the resident texture has premultiplied alpha
+			*/
+			bool premultiplied = false;
+
+			/**
+			* size of the image, it changes if the file is changed (copies of the Texture keep the old size)
+			*/
+			int width = 0, height = 0;
+
+			/**
+			* bytes used by the resident texture
+			*/
+			size_t bytes = 0;
+
+			/**
+			* position of this entry in managedLru (valid only while resident)
+			*/
+			std::list<int>::iterator lruPosition;
+
+			/**
+			* false if this slot is free
+			*/
+			bool used = false;
+
+			/**
+			* number which changes when this slot is freed, so copies of a freed Texture don't use the next one
+			*/
+			Uint32 generation = 0;
+		};
+
+		/**
+		* all managed textures, indexed by Texture::managedIndex
+		*/
+		std::vector<ManagedTexture> managedTextures;
+
+		/**
+		* free slots of managedTextures which can be reused
+		*/
+		std::vector<int> freeManagedSlots;
+
+		/**
+		* resident managed textures, most recently drawn first
+		*/
+		std::list<int> managedLru;
+
+		/**
+		* maximum bytes of resident managed textures (0 means unlimited)
+		*/
+		size_t textureBudget = 0;
+
+		/**
+		* bytes of managed textures which are resident now
+		*/
+		size_t residentTextureBytes = 0;
+
+		/**
+		* number of managed textures evicted because of the budget
+		*/
+		unsigned int textureEvictions = 0;
+
+		/**
+		* number of managed textures reloaded from disk after eviction
+		*/
+		unsigned int textureReloads = 0;
+
+		/**
+		* calculate memory which is used by a texture
+		* @param texture the SDL texture
+		* @return size of texture in bytes
+		*/
+		size_t textureBytes(SDL_Texture *texture) {
+			Uint32 format;
+			int w, h;
+			if (SDL_QueryTexture(texture, &format, nullptr, &w, &h) < 0)
+				return 0;
+			return size_t(w) * size_t(h) * SDL_BYTESPERPIXEL(format);
+		}
+
+		/**
+		* evict least recently drawn managed textures until resident bytes fit in the budget
+		* @param keep index of a managed texture which must not be evicted (-1 for none)
+		*/
+		void evictManagedTextures(int keep) {
+			while (textureBudget != 0 && residentTextureBytes > textureBudget && !managedLru.empty()) {
+				int index = managedLru.back();
+				if (index == keep)
+					break;
+				ManagedTexture &entry = managedTextures[index];
+				if (entry.texture == geometryTexture)
+					flushGeometry();
+				SDL_DestroyTexture(entry.texture);
+				entry.texture = nullptr;
+				residentTextureBytes -= entry.bytes;
+				entry.bytes = 0;
+				managedLru.pop_back();
+				textureEvictions++;
+			}
+		}
+
+		/**
+		* load a managed texture from disk and make it the most recently used one
+		* @param index index of managed texture
+		* @return false if file can't be loaded
+		*/
+		bool residentManagedTexture(int index) {
+			ManagedTexture &entry = managedTextures[index];
+			bool opaque;
+			SDL_Surface *pic = decodeImage(entry.path, entry.changeColor, entry.r, entry.g, entry.b, entry.alpha,
+				entry.premultiply, opaque);
+			if (pic == nullptr)
+				return false;
+			Texture loaded = uploadImage(pic, opaque, entry.premultiply);
+			SDL_FreeSurface(pic);
+			if (loaded.underneathTexture == nullptr)
+				return false;
+			entry.texture = loaded.underneathTexture;
+			entry.premultiplied = loaded.premultiplied;
+			entry.width = loaded.width;
+			entry.height = loaded.height;
+			if (entry.blendMode != SDL_BLENDMODE_INVALID)
+				SDL_SetTextureBlendMode(entry.texture, entry.blendMode);
+			entry.bytes = textureBytes(entry.texture);
+			residentTextureBytes += entry.bytes;
+			managedLru.push_front(index);
+			entry.lruPosition = managedLru.begin();
+			evictManagedTextures(index);
+			return true;
+		}
+
+		/**
+		* a texture which is created by createStreamingTexture
+		* pixels live in memory and changed regions are uploaded to the back texture on unlock, so
+		* drawing the front texture never waits for an upload
+		*/
+		struct StreamingTexture {
+			/**
+			* SDL textures, only the first one is used if it is not double buffered
+			*/
+			SDL_Texture *textures[2] = { nullptr, nullptr };
+
+			/**
+			* index of texture which is drawn now
+			*/
+			int front = 0;
+
+			/**
+			* true if two textures are used
+			*/
+			bool doubleBuffered = true;
+
+			/**
+			* pixels of texture in ARGB8888 format
+			*/
+			std::vector<Uint32> pixels;
+			int width = 0, height = 0;
+
+			/**
+			* region of each texture which is older than pixels
+			*/
+			SDL_Rect dirty[2] = { { 0, 0, 0, 0 }, { 0, 0, 0, 0 } };
+
+			/**
+			* region which is locked now (empty if it is not locked)
+			*/
+			SDL_Rect locked = { 0, 0, 0, 0 };
+
+			/**
+			* false if this slot is free
+			*/
+			bool used = false;
+		};
+
+		/**
+		* all streaming textures, indexed by Texture::streamingIndex
+		*/
+		std::vector<StreamingTexture> streamingTextures;
+
+		/**
+		* free slots of streamingTextures which can be reused
+		*/
+		std::vector<int> freeStreamingSlots;
+
+		/**
+		* smallest rectangle which contains two rectangles (empty rectangles are ignored)
+		*/
+		SDL_Rect unionRect(const SDL_Rect &first, const SDL_Rect &second) {
+			if (first.w <= 0 || first.h <= 0)
+				return second;
+			if (second.w <= 0 || second.h <= 0)
+				return first;
+			int x1 = std::min(first.x, second.x), y1 = std::min(first.y, second.y);
+			int x2 = std::max(first.x + first.w, second.x + second.w);
+			int y2 = std::max(first.y + first.h, second.y + second.h);
+			return { x1, y1, x2 - x1, y2 - y1 };
+		}
+
+		/**
+		* mark a region of streaming texture as changed and upload it to the back texture
+		* @param index index of streaming texture
+		* @param region changed region
+		*/
+		void commitStreamingTexture(int index, const SDL_Rect &region) {
+			StreamingTexture &entry = streamingTextures[index];
+			entry.dirty[0] = unionRect(entry.dirty[0], region);
+			entry.dirty[1] = unionRect(entry.dirty[1], region);
+
+			int back = entry.doubleBuffered ? 1 - entry.front : entry.front;
+			SDL_Rect &dirty = entry.dirty[back];
+			if (dirty.w > 0 && dirty.h > 0) {
+				// batched draws of this texture must still see the old pixels
+				if (entry.textures[back] == geometryTexture)
+					flushGeometry();
+				SDL_UpdateTexture(entry.textures[back], &dirty,
+					&entry.pixels[size_t(dirty.y) * entry.width + dirty.x], entry.width * int(sizeof(Uint32)));
+			}
+			dirty = { 0, 0, 0, 0 };
+			entry.front = back;
+		}
+
+		/**
+		* destroy a streaming texture and release its slot
+		* @param index index of streaming texture
+		*/
+		void freeStreamingTexture(int index) {
+			StreamingTexture &entry = streamingTextures[index];
+			if (!entry.used)
+				return;
+			for (SDL_Texture *texture : entry.textures)
+				if (texture != nullptr)
+					SDL_DestroyTexture(texture);
+			entry = StreamingTexture();
+			freeStreamingSlots.push_back(index);
+		}
+
+		/**
+		* find SDL texture which must be drawn for a Texture
+		* managed textures are marked as recently used and reloaded if they were evicted
+		* @param texture the Texture
+		* @return SDL texture to draw, nullptr if texture is freed or its file can't be loaded again
+		*/
+		SDL_Texture *underneath(const Texture &texture) {
+			if (texture.streamingIndex >= 0) {
+				const StreamingTexture &entry = streamingTextures[texture.streamingIndex];
+				return entry.textures[entry.front];
+			}
+			if (texture.managedIndex < 0)
+				return texture.underneathTexture;
+			ManagedTexture &entry = managedTextures[texture.managedIndex];
+			if (!entry.used || entry.generation != texture.managedGeneration)
+				return nullptr;
+			if (entry.texture == nullptr) {
+				if (!residentManagedTexture(texture.managedIndex)) {
+					SDL_Log("SBDL: unable to reload %s", entry.path.c_str());
+					return nullptr;
+				}
+				textureReloads++;
+			}
+			else
+				managedLru.splice(managedLru.begin(), managedLru, entry.lruPosition);
+			return entry.texture;
+		}
+
+		/**
+		* get a Texture with current size and premultiplied flag
+		* a managed texture gets them from its file when it is reloaded, but copies of the Texture keep the old ones
+		* @param texture the Texture
+		* @return copy of texture with current size and premultiplied flag
+		*/
+		Texture currentTexture(const Texture &texture) {
+			Texture current = texture;
+			if (texture.managedIndex >= 0) {
+				const ManagedTexture &entry = managedTextures[texture.managedIndex];
+				if (entry.used && entry.generation == texture.managedGeneration) {
+					current.width = entry.width;
+					current.height = entry.height;
+					current.premultiplied = entry.premultiplied;
+				}
+			}
+			return current;
+		}
+
+		/**
+		* start batching geometry of a Texture with a tint
+		* opaque textures are blended if tint is transparent
+		* @param texture the Texture
+		* @param tint color and transparency of vertices, it is changed to color of vertices
+		* (premultiplied if texture has premultiplied alpha)
+		* @return false if texture can't be drawn
+		*/
+		bool batchTexture(const Texture &texture, SDL_Color &tint) {
+			SDL_Texture *underneathTexture = underneath(texture);
+			if (underneathTexture == nullptr)
+				return false;
+			SDL_BlendMode blendMode = SDL_BLENDMODE_INVALID;
+			if (tint.a != 255) {
+				SDL_BlendMode textureBlendMode;
+				if (SDL_GetTextureBlendMode(underneathTexture, &textureBlendMode) == 0 &&
+					textureBlendMode == SDL_BLENDMODE_NONE)
+					blendMode = SDL_BLENDMODE_BLEND;
+			}
+			batchGeometry(underneathTexture, blendMode);
+
+			// flag of the entry is read after underneath, which may reload the texture
+			if (currentTexture(texture).premultiplied) {
+				tint.r = Uint8(tint.r * tint.a / 255);
+				tint.g = Uint8(tint.g * tint.a / 255);
+				tint.b = Uint8(tint.b * tint.a / 255);
+			}
+			return true;
+		}
+
+		/**
+		* create a managed texture and load it for the first time
+		* @return texture which is created
+		*/
+		Texture loadManagedTextureUnderneath(const std::string &path, bool changeColor, Uint8 r, Uint8 g, Uint8 b,
+			Uint8 alpha, bool premultiply) {
+			int index;
+			if (freeManagedSlots.empty()) {
+				index = int(managedTextures.size());
+				managedTextures.emplace_back();
+			}
+			else {
+				index = freeManagedSlots.back();
+				freeManagedSlots.pop_back();
+			}
+
+			ManagedTexture &entry = managedTextures[index];
+			entry.path = path;
+			entry.changeColor = changeColor;
+			entry.r = r;
+			entry.g = g;
+			entry.b = b;
+			entry.alpha = alpha;
+			entry.premultiply = premultiply;
+			entry.used = true;
+			if (!residentManagedTexture(index)) {
+				const std::string message = "Missing Image file: " + path;
+				SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "SBDL load image error", message.c_str(), nullptr);
+				exit(1);
+			}
+
+			Texture newTexture;
+			newTexture.width = entry.width;
+			newTexture.height = entry.height;
+			newTexture.managedIndex = index;
+			newTexture.managedGeneration = entry.generation;
+			newTexture.premultiplied = entry.premultiplied;
+
+			watchTexture(path, changeColor, r, g, b, alpha, premultiply, nullptr, index);
+			return newTexture;
+		}
+
+		/**
+		* destroy a managed texture and release its slot
+		* @param index index of managed texture
+		*/
+		void freeManagedTexture(int index) {
+			ManagedTexture &entry = managedTextures[index];
+			if (!entry.used)
+				return;
+			if (entry.texture != nullptr) {
+				SDL_DestroyTexture(entry.texture);
+				residentTextureBytes -= entry.bytes;
+				managedLru.erase(entry.lruPosition);
+			}
+			Uint32 generation = entry.generation + 1;
+			entry = ManagedTexture();
+			entry.generation = generation;
+			freeManagedSlots.push_back(index);
+		}
+
+		/**
+		* stop watching the files of a texture or sound which is freed
+		* @param texture SDL texture which is freed (or nullptr)
+		* @param managedIndex index of managed texture which is freed (or -1)
+		* @param sound sound which is freed (or nullptr)
+		*/
+		void forgetAsset(SDL_Texture *texture, int managedIndex, Mix_Chunk *sound) {
+			if (!hotReloadEnabled)
+				return;
+			std::lock_guard<std::mutex> lock(hotReloadMutex);
+			hotReloadAssets.erase(std::remove_if(hotReloadAssets.begin(), hotReloadAssets.end(),
+				[&](const HotReloadAsset &asset) {
+				return (texture != nullptr && asset.texture == texture) ||
+					(managedIndex >= 0 && asset.managedIndex == managedIndex) ||
+					(sound != nullptr && asset.sound == sound);
+			}), hotReloadAssets.end());
+		}
+
+		/**
+		* load a texture with premultiplied alpha setting and watch its file if hot reload is enabled
+		* @return texture which is loaded
+		*/
+		Texture loadWatchedTexture(const std::string &path, bool changeColor, Uint8 r, Uint8 g, Uint8 b,
+			Uint8 alpha) {
+			Texture newTexture = loadTextureUnderneath(path, changeColor, r, g, b, alpha, premultiplyAlpha);
+			watchTexture(path, changeColor, r, g, b, alpha, premultiplyAlpha, newTexture.underneathTexture, -1);
+			return newTexture;
+		}
+
+		/**
+		* replace assets with the decoded ones
+		* called at the start of a frame, so an asset never changes in the middle of a frame
+		*/
+		void applyHotReloads() {
+			std::vector<HotReloadResult> results;
+			std::vector<HotReloadAsset> assets;
+			{
+				std::lock_guard<std::mutex> lock(hotReloadMutex);
+				results.swap(hotReloadResults);
+				hotReloadReady.store(false, std::memory_order_relaxed);
+				assets = hotReloadAssets;
+			}
+
+			for (HotReloadResult &result : results) {
+				const HotReloadAsset *asset = nullptr;
+				for (const HotReloadAsset &watched : assets)
+					if (watched.id == result.id)
+						asset = &watched;
+
+				if (asset != nullptr && asset->sound != nullptr) {
+					// samples are swapped by the audio thread, and old ones are freed after it
+					MixerCommand command;
+					command.type = MixerCommandType::ReplaceSound;
+					command.sound = asset->sound;
+					command.replacement = result.sound;
+					if (!audioQueueEnabled)
+						runMixerCommand(command);
+					else if (pushMixerCommand(command)) {
+						freeChunkLater(result.sound, mixerCommandsSent);
+						result.sound = nullptr;
+					}
+					else
+						SDL_Log("SBDL hot reload: audio queue is full, %s/%s is not reloaded",
+							asset->directory.c_str(), asset->name.c_str());
+				}
+				else if (asset != nullptr && asset->managedIndex >= 0) {
+					ManagedTexture &entry = managedTextures[asset->managedIndex];
+					if (entry.texture != nullptr) {
+						// old texture is kept if the new one can't be created (e.g. it is too large)
+						Texture loaded = uploadImage(result.surface, result.opaque, entry.premultiply);
+						if (loaded.underneathTexture == nullptr) {
+							SDL_Log("SBDL hot reload: unable to create texture of %s/%s",
+								asset->directory.c_str(), asset->name.c_str());
+							SDL_FreeSurface(result.surface);
+							continue;
+						}
+						flushGeometry();
+						SDL_DestroyTexture(entry.texture);
+						residentTextureBytes -= entry.bytes;
+						entry.texture = loaded.underneathTexture;
+						entry.premultiplied = loaded.premultiplied;
+						entry.width = loaded.width;
+						entry.height = loaded.height;
+						entry.bytes = textureBytes(entry.texture);
+						residentTextureBytes += entry.bytes;
+						if (entry.blendMode != SDL_BLENDMODE_INVALID)
+							SDL_SetTextureBlendMode(entry.texture, entry.blendMode);
+						// a bigger image may exceed the budget
+						managedLru.splice(managedLru.begin(), managedLru, entry.lruPosition);
+						evictManagedTextures(asset->managedIndex);
+					}
+				}
+				else if (asset != nullptr && asset->texture != nullptr) {
+					int w, h;
+					SDL_QueryTexture(asset->texture, nullptr, nullptr, &w, &h);
+					if (w == result.surface->w && h == result.surface->h) {
+						flushGeometry();
+						SDL_UpdateTexture(asset->texture, nullptr, result.surface->pixels, result.surface->pitch);
+					}
+					else
+						SDL_Log("SBDL hot reload: size of %s/%s is changed, use loadManagedTexture to reload it",
+							asset->directory.c_str(), asset->name.c_str());
+				}
+
+				if (result.sound != nullptr)
+					freeChunk(result.sound);
+				if (result.surface != nullptr)
+					SDL_FreeSurface(result.surface);
+			}
+		}
+
+		/**
+		* kind of an asset in a manifest
+		*/
+		enum class AssetKind { Texture, Sound, Music, Font };
+
+		/**
+		* an asset which is listed in a manifest
+		* assets with the same file and options are loaded once even if they are in many groups
+		*/
+		struct ManifestAsset {
+			AssetKind kind = AssetKind::Texture;
+			std::string path;
+
+			/**
+			* options of textures
+			*/
+			bool changeColor = false;
+			Uint8 r = 0, g = 0, b = 0, alpha = 255;
+			bool managed = false;
+
+			/**
+			* size of fonts
+			*/
+			int size = 0;
+
+			/**
+			* number of loaded groups which contain this asset
+			*/
+			int references = 0;
+
+			/**
+			* loaded asset (one of them is set while it is loaded)
+			*/
+			Texture texture;
+			Mix_Chunk *sound = nullptr;
+			Mix_Music *music = nullptr;
+			TTF_Font *font = nullptr;
+
+			/**
+			* check whether two assets are the same file loaded with the same options
+			*/
+			bool sameAs(const ManifestAsset &other) const {
+				return kind == other.kind && path == other.path && changeColor == other.changeColor && r == other.r &&
+					g == other.g && b == other.b && alpha == other.alpha && managed == other.managed &&
+					size == other.size;
+			}
+
+			/**
+			* check whether this asset is loaded
+			*/
+			bool loaded() const {
+				return texture.underneathTexture != nullptr || texture.managedIndex >= 0 || sound != nullptr ||
+					music != nullptr || font != nullptr;
+			}
+		};
+
+		/**
+		* all assets of loaded manifests
+		*/
+		std::vector<ManifestAsset> manifestAssets;
+
+		/**
+		* index of asset in manifestAssets by id
+		*/
+		std::map<std::string, int> manifestIds;
+
+		/**
+		* indices of assets in manifestAssets by group name
+		*/
+		std::map<std::string, std::vector<int>> manifestGroups;
+
+		/**
+		* names of groups which are loaded now
+		*/
+		std::vector<std::string> loadedGroups;
+
+		/**
+		* an asset which is decoded by a loader thread and uploaded by the main thread
+		*/
+		struct LoadJob {
+			int asset = -1;
+			SDL_Surface *surface = nullptr;
+			bool opaque = false;
+			Mix_Chunk *sound = nullptr;
+			Mix_Music *music = nullptr;
+			bool ready = false;
+		};
+
+		/**
+		* show an error for a manifest and exit
+		* @param message the error
+		*/
+		void manifestError(const std::string &message) {
+			SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "SBDL manifest error", message.c_str(), nullptr);
+			exit(1);
+		}
+
+		/**
+		* find asset of an id in loaded manifests
+		* @param id id of asset
+		* @param kind expected kind of asset
+		* @return the asset which is loaded
+		*/
+		ManifestAsset &findAsset(const std::string &id, AssetKind kind) {
+			std::map<std::string, int>::const_iterator found = manifestIds.find(id);
+			if (found == manifestIds.end() || manifestAssets[found->second].kind != kind)
+				manifestError("Unknown asset: " + id);
+			ManifestAsset &asset = manifestAssets[found->second];
+			if (!asset.loaded())
+				manifestError("Asset is not loaded: " + id);
+			return asset;
+		}
+
+		/**
+		* key of an asset which is used to find its id in manifest (texture or managed slot or sound or music)
+		*/
+		typedef std::pair<const void *, int> AssetKey;
+
+		/**
+		* make key of a loaded asset of manifest
+		*/
+		AssetKey assetKey(const ManifestAsset &asset) {
+			if (asset.kind == AssetKind::Texture)
+				return AssetKey(asset.texture.underneathTexture, asset.texture.managedIndex);
+			return AssetKey(asset.sound != nullptr ? (const void *)asset.sound : asset.music, -1);
+		}
+
+		/**
+		* header of a binary save file
+		*/
+		struct SaveHeader {
+			char magic[4];
+			Uint32 formatVersion;
+			Uint32 version;
+			Uint32 byteOrder;
+			Uint64 assetsOffset;
+			Uint64 size;
+		};
+
+		/**
+		* version of binary save format and a value which shows byte order of machine which wrote a file
+		*/
+		const Uint32 saveFormatVersion = 1;
+		const Uint32 saveByteOrder = 0x01020304;
+
+		/**
+		* alignment of arrays in binary save files, so they can be used in place
+		*/
+		const size_t saveAlignment = 16;
+
+		/**
+		* write bytes to a temporary file and rename it to path, so path has the old or the new file even if
+		* program crashes while writing
+		* @return true if file is written
+		*/
+		bool writeFileAtomic(const std::string &path, const std::vector<char> &bytes) {
+			// overlapping saves of the same file must not write into the same temporary file
+			static std::atomic<unsigned int> nextTemporary(0);
+			const std::string temporary = path + "." + std::to_string(std::hash<std::thread::id>()(
+				std::this_thread::get_id())) + "." + std::to_string(nextTemporary.fetch_add(1)) + ".tmp";
+			FILE *file = fopen(temporary.c_str(), "wb");
+			if (file == nullptr)
+				return false;
+			bool written = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size() && fflush(file) == 0;
+#if defined(__linux__)
+			written = written && fsync(fileno(file)) == 0;
+#endif
+			written = fclose(file) == 0 && written;
+#if defined(_WIN32) || defined(_WIN64)
+			// rename doesn't replace files on Windows
+			if (written)
+				std::remove(path.c_str());
+#endif
+			if (!written || std::rename(temporary.c_str(), path.c_str()) != 0) {
+				std::remove(temporary.c_str());
+				return false;
+			}
+			return true;
+		}
+
+		/**
+		* release SDL at exit of program
+		* background threads are stopped first, and resources which are freed after this call are
+		* ignored by owning handles
+		*/
+		void quit() {
+			// let background saves finish, so a save file is never lost at exit
+			while (pendingSaves.load() > 0)
+				std::this_thread::yield();
+			stopHotReload();
+			stopPostWorkers();
+			// the audio thread never uses sounds which wait to be freed after this
+			if (audioQueueEnabled)
+				Mix_SetPostMix(nullptr, nullptr);
+			for (const DeferredSound &deferred : deferredSounds)
+				freeChunk(deferred.sound);
+			deferredSounds.clear();
+			quitted = true;
+			SDL_Quit();
+		}
+	}
+
+	/**
+	* comparator of SDL_Rect
+	*/
+	bool operator==(const SDL_Rect &x, const SDL_Rect &y) {
+		return x.x == y.x && x.y == y.y && x.h == y.h && x.w == y.w;
+	}
+
+	/**
+	* a structure which give useful information about mouse state
+	* updateEvents must be call before using this structure
+	*/
+	struct Mouse {
+		/**
+		* x position of Mouse
+		*/
+		int x;
+
+		/**
+		* y position of Mouse
+		*/
+		int y;
+
+		/**
+		* left button state
+		*/
+		bool left;
+
+		/**
+		* right button state
+		*/
+		bool right;
+
+		/**
+		* middle button state
+		*/
+		bool middle;
+
+		/**
+		* state of Mouse  < SDL_PRESSED or SDL_RELEASED >
+		*/
+		Uint8 state;
+
+		/**
+		* button clicks
+		*/
+		Uint8 clicks;
+
+		/**
+		* for SDL backward compatibility
+		*/
+		Uint8 button;
+
+		/**
+		 * Check if Mouse clicked with given conditions.
+		 * @param button button to check <SDL_BUTTON_LEFT,SDL_BUTTON_RIGHT,SDL_BUTTON_MIDDLE>
+		 * @param clicks number of clicks
+		 * @param state sate of mouse <SDL_PRESSED,SDL_RELEASED>
+		 */
+		bool clicked(Uint8 button = SDL_BUTTON_LEFT, Uint8 clicks = 1, Uint8 state = SDL_PRESSED) {
+			return this->button == button && this->clicks == clicks && this->state == state;
+		}
+	} Mouse;
+
+	/**
+	* check state of program
+	* @return state of SDL
+	*/
+	bool isRunning() {
+		return Core::running;
+	}
+
+	/**
+	* stop SBDL and SBDL::isRunning will return false later
+	*/
+	void stop() {
+		Core::running = false;
+	}
+
+	/**
+	* indicate whether a key with specific scanCode was pressed
+	* @param scanCode specific code for each keyboard button (https://wiki.libsdl.org/SDL_Scancode)
+	* @return true if specific keyboard button was pressed
+	*/
+	bool keyPressed(SDL_Scancode scanCode) {
+		return !Core::old_keystate[scanCode] && Core::keystate[scanCode];
+	}
+
+	/**
+	* indicate whether a key with specific scanCode was released
+	* @param scanCode specific code for each keyboard button (https://wiki.libsdl.org/SDL_Scancode)
+	* @return true if specific keyboard button was released
+	*/
+	bool keyReleased(SDL_Scancode scanCode) {
+		return Core::old_keystate[scanCode] && !Core::keystate[scanCode];
+	}
+
+	/**
+	* indicate whether a key with specific scanCode is hold
+	* @param scanCode specific code for each keyboard button (https://wiki.libsdl.org/SDL_Scancode)
+	* @return true if specific keyboard button is hold
+	*/
+	bool keyHeld(SDL_Scancode scanCode) {
+		return Core::old_keystate[scanCode] && Core::keystate[scanCode];
+	}
+
+	/**
+	* set buffer size and sample rate of audio device, call it before InitEngine
+	* smaller buffers have less latency, but slow machines may not fill them in time (use getAudioStats)
+	* @param samples number of sample frames in each buffer (default is 640)
+	* @param frequency sample rate in Hz (default is 22050)
+	*/
+	void setAudioBufferSize(int samples, int frequency = 22050) {
+		Core::audioBufferSize = std::max(64, samples);
+		Core::audioFrequency = frequency;
+	}
+
+	/**
+	* initialize SDL and show a simple empty window for drawing texture on it
+	* before start using SDL functions and types, first initialize engine
+	* @param windowsTitle title of window
+	* @param windowsWidth width of window
+	* @param windowsHeight height of window
+	* @param r red color of default background
+	* @param g green color of default background
+	* @param b blue color of default background
+	* @param windowFlags more SDL window flags, for example SDL_WINDOW_RESIZABLE, SDL_WINDOW_ALLOW_HIGHDPI or
+	* SDL_WINDOW_FULLSCREEN_DESKTOP, the game uses windowsWidth * windowsHeight coordinates in any size of window
+	*/
+	void InitEngine(const std::string &windowsTitle, int windowsWidth, int windowsHeight,
+		Uint8 r = 255, Uint8 g = 255, Uint8 b = 255, Uint32 windowFlags = 0) {
+		atexit(Core::quit); // set a SDL_Quit as exit function
+		if (SDL_Init(SDL_INIT_VIDEO) < 0) {
 			SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "SBDL initialization", "SBDL initialize video engine error",
 				nullptr);
 			exit(1);
 		}
 
-		SDL_CreateWindowAndRenderer(windowsWidth, windowsHeight, SDL_WINDOW_SHOWN, &Core::window, &Core::renderer);
-		SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");  // make the scaled rendering look smoother
-		SDL_RenderSetLogicalSize(Core::renderer, windowsWidth, windowsHeight);
-		SDL_SetRenderDrawColor(Core::renderer, r, g, b, 255);
-		SDL_SetRenderDrawBlendMode(Core::renderer, SDL_BLENDMODE_BLEND);
+		SDL_CreateWindowAndRenderer(windowsWidth, windowsHeight, SDL_WINDOW_SHOWN | windowFlags, &Core::window,
+			&Core::renderer);
+		SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");  // make the scaled rendering look smoother
+		SDL_RenderSetLogicalSize(Core::renderer, windowsWidth, windowsHeight);
+		Core::logicalWidth = windowsWidth;
+		Core::logicalHeight = windowsHeight;
+		Core::updateSceneTarget();
+		SDL_SetRenderDrawColor(Core::renderer, r, g, b, 255);
+		SDL_SetRenderDrawBlendMode(Core::renderer, SDL_BLENDMODE_BLEND);
+
+		// the software renderer has no custom blend modes, so premultiplied alpha can't be drawn there
+		SDL_Texture *probe = SDL_CreateTexture(Core::renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, 1, 1);
+		Core::customBlendModes = probe != nullptr &&
+			SDL_SetTextureBlendMode(probe, Core::premultipliedBlendMode()) == 0;
+		if (probe != nullptr)
+			SDL_DestroyTexture(probe);
+
+		SDL_SetWindowTitle(Core::window, windowsTitle.c_str());
+		// inilialize SDL_mixer, exit if fail
+		if (SDL_Init(SDL_INIT_AUDIO) < 0) {
+			SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "SBDL initialization", "SBDL initialize audio engine error",
+				nullptr);
+			exit(1);
+		}
+
+		// setup audio mode, SDL_mixer commands are done in the audio thread after it is open
+		if (Mix_OpenAudio(Core::audioFrequency, AUDIO_S16SYS, 2, Core::audioBufferSize) == 0) {
+			int frequency, channels;
+			Uint16 format;
+			if (Mix_QuerySpec(&frequency, &format, &channels) != 0 && frequency > 0) {
+				// device may change the requested buffer size, postMix measures the real one
+				Core::audioDeviceFrequency = frequency;
+				Core::audioFrameBytes = channels * SDL_AUDIO_BITSIZE(format) / 8;
+				Core::audioBufferTicks = Core::audioBufferSize * SDL_GetPerformanceFrequency() / frequency;
+			}
+			Mix_SetPostMix(Core::postMix, nullptr);
+			Core::audioQueueEnabled = true;
+		}
+		// setup text system
+		TTF_Init();
+	}
+
+	/**
+	* update state of keyboard buttons (release or push) and mouse
+	* call this function in a loop after initialize engine for get updated state all times
+	*/
+	void updateEvents() {
+		// replace assets which are changed on disk at the frame boundary
+		if (Core::hotReloadEnabled && Core::hotReloadReady.load(std::memory_order_acquire))
+			Core::applyHotReloads();
+		// free sounds which the audio thread doesn't use anymore
+		if (!Core::deferredSounds.empty())
+			Core::freeDeferredSounds();
+
+		// update keyboard state
+		if (Core::keystate_size == -1) {
+			Core::keystate = SDL_GetKeyboardState(&Core::keystate_size);
+			Core::old_keystate = new Uint8[Core::keystate_size];
+			for (int i = 0; i < Core::keystate_size; i++)
+				Core::old_keystate[i] = 0;
+		}
+		else {
+			for (int i = 0; i < Core::keystate_size; i++)
+				Core::old_keystate[i] = Core::keystate[i];
+			Core::keystate = SDL_GetKeyboardState(&Core::keystate_size);
+		}
+		SDL_PumpEvents();
+
+		// reset event handler state for check it again
+		Core::event = {};
+		Core::windowResized = false;
+
+		// returns true if there is an event in the queue, but will not remove it
+		if (!SDL_PollEvent(nullptr)) {
+			Mouse.left = Mouse.middle = Mouse.right = false;
+			Mouse.button = 0;
+		}
+		else {
+			while (SDL_PollEvent(&Core::event)) { // loop until there is a new event for handling
+				if (Core::event.type == SDL_MOUSEBUTTONDOWN || Core::event.type == SDL_MOUSEBUTTONUP) {
+					// update state of Mouse structure if it was changed
+					switch (Core::event.button.button) {
+					case 1:
+						Mouse.left = true;
+						Mouse.right = Mouse.middle = false;
+						break;
+					case 2:
+						Mouse.middle = true;
+						Mouse.right = Mouse.left = false;
+						break;
+					case 3:
+						Mouse.right = true;
+						Mouse.left = Mouse.middle = false;
+						break;
+					default:
+						Mouse.left = Mouse.middle = Mouse.right = false;
+					}
+
+					Mouse.state = Core::event.button.state;
+					Mouse.button = Core::event.button.button;
+					Mouse.clicks = Core::event.button.clicks;
+				}
+				// update position of mouse if it was changed
+				if (Core::event.type == SDL_MOUSEMOTION) {
+					Mouse.x = Core::event.motion.x;
+					Mouse.y = Core::event.motion.y;
+				}
+				if (Core::event.type == SDL_QUIT) {
+					Core::running = false;
+				}
+				// SDL scales game coordinates to new size of window, only scene target must be resized
+				if (Core::event.type == SDL_WINDOWEVENT && Core::event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+					Core::windowResized = true;
+					Core::updateSceneTarget();
+				}
+			}
+		}
+
+		// timers and scripts run after input of this frame is read
+		Core::frameNumber++;
+		Core::runTimers();
+#ifdef SBDL_COROUTINES
+		Core::resumeTasks();
+#endif
+	}
+
+	/**
+	* get Milliseconds since program was started.
+	*/
+	unsigned int getTime() {
+		return SDL_GetTicks();
+	}
+
+	/**
+	* get number of frames (calls of updateEvents) since start
+	*/
+	Uint64 getFrameNumber() {
+		return Core::frameNumber;
+	}
+
+	/**
+	* id of a timer, it is never used again after the timer is finished
+	*/
+	typedef Uint64 TimerId;
+
+	/**
+	* call a function after some milliseconds, callbacks are called by updateEvents at start of frame
+	* @param delay milliseconds until the call
+	* @param callback the function
+	* @param repeat call the function every delay milliseconds until timer is canceled
+	* @return id of timer which can be canceled
+	*/
+	TimerId addTimer(Uint32 delay, std::function<void()> callback, bool repeat = false) {
+		return Core::timeTimers.add(SDL_GetTicks(), delay, repeat ? std::max(Uint32(1), delay) : 0,
+			std::move(callback));
+	}
+
+	/**
+	* call a function after some frames, callbacks are called by updateEvents at start of frame
+	* @param frames number of frames until the call
+	* @param callback the function
+	* @param repeat call the function every some frames until timer is canceled
+	* @return id of timer which can be canceled
+	*/
+	TimerId addFrameTimer(Uint32 frames, std::function<void()> callback, bool repeat = false) {
+		return Core::frameTimers.add(Core::frameNumber, frames, repeat ? std::max(Uint32(1), frames) : 0,
+			std::move(callback));
+	}
+
+	/**
+	* cancel a timer before its call (or stop a repeating timer)
+	* @param timer id of timer
+	* @return false if timer is finished or canceled before
+	*/
+	bool cancelTimer(TimerId timer) {
+		return (timer & 1) == 0 ? Core::frameTimers.cancel(timer) : Core::timeTimers.cancel(timer);
+	}
+
+	/**
+	* clear the current rendering target
+	*/
+	void clearRenderScreen() {
+		Core::flushGeometry();
+		SDL_RenderClear(Core::renderer);
+		Core::frameStart = SDL_GetPerformanceCounter();
+	}
+
+	/**
+	* update the screen and apply all changes
+	*/
+	void updateRenderScreen() {
+		Core::flushGeometry();
+		if (Core::lightMap != nullptr && !Core::hudActive)
+			Core::compositeLights();
+		if (Core::sceneTarget != nullptr && !Core::hudActive)
+			Core::presentSceneTarget();
+		Core::hudActive = false;
+		// the frame is measured before present, because present waits for vertical sync (batched draws are
+		// flushed first)
+		Core::updateDynamicResolution();
+		SDL_RenderPresent(Core::renderer);
+		if (Core::sceneTarget != nullptr)
+			Core::bindSceneTarget();
+	}
+
+	/**
+	* draw the rest of this frame in full resolution of window without lights and post-processing (for HUD and text)
+	* the scene which is drawn before is lit and upscaled to window now
+	*/
+	void beginHud() {
+		if (Core::hudActive)
+			return;
+		if (Core::lightMap != nullptr)
+			Core::compositeLights();
+		if (Core::sceneTarget != nullptr)
+			Core::presentSceneTarget();
+		Core::hudActive = true;
+	}
+
+	/**
+	* fullscreen modes of window
+	* Desktop uses resolution of desktop and is faster to switch, Fullscreen changes resolution of display
+	*/
+	enum class FullscreenMode { Windowed, Fullscreen, Desktop };
+
+	/**
+	* change fullscreen mode of window, game coordinates are not changed
+	* @param mode the mode
+	* @return false if mode can't be changed
+	*/
+	bool setFullscreen(FullscreenMode mode) {
+		Uint32 flags = mode == FullscreenMode::Fullscreen ? SDL_WINDOW_FULLSCREEN :
+			mode == FullscreenMode::Desktop ? SDL_WINDOW_FULLSCREEN_DESKTOP : 0;
+		Core::flushGeometry();
+		if (SDL_SetWindowFullscreen(Core::window, flags) != 0)
+			return false;
+		Core::updateSceneTarget();
+		return true;
+	}
+
+	/**
+	* draw the scene in lower resolution and upscale it to window once per frame
+	* slow machines can draw faster with less pixels, it can be changed at any time
+	* @param scale resolution of scene relative to pixels of window (0.25 to 1, 1 to draw to window directly)
+	* @param smooth true to upscale with linear filter, false for sharp pixels
+	*/
+	void setRenderScale(float scale, bool smooth = true) {
+		Core::changeRenderScale(scale, smooth);
+	}
+
+	/**
+	* get resolution of scene relative to pixels of window
+	*/
+	float getRenderScale() {
+		return Core::renderScale;
+	}
+
+	/**
+	* settings of dynamic resolution
+	* @see enableDynamicResolution
+	*/
+	using DynamicResolutionSettings = Core::DynamicResolutionSettings;
+
+	/**
+	* change render scale automatically to keep time of drawing each frame in a budget
+	* time is measured from clearRenderScreen to updateRenderScreen, draw HUD after beginHud to keep it sharp
+	* @param settings budget and hysteresis of controller
+	*/
+	void enableDynamicResolution(const DynamicResolutionSettings &settings = DynamicResolutionSettings()) {
+		Core::dynamicResolutionSettings = settings;
+		Core::dynamicResolution = true;
+		Core::framesSinceScaleChange = 0;
+		Core::changeRenderScale(std::max(settings.minScale, std::min(settings.maxScale, Core::renderScale)),
+			Core::smoothUpscale);
+	}
+
+	/**
+	* stop changing render scale automatically, render scale is set to 1
+	*/
+	void disableDynamicResolution() {
+		Core::dynamicResolution = false;
+		Core::changeRenderScale(1, Core::smoothUpscale);
+	}
+
+	/**
+	* statistics of frame time and dynamic resolution, times are in milliseconds
+	*/
+	struct DynamicResolutionStats {
+		float scale = 1;
+		double frameTime = 0, averageFrameTime = 0;
+		unsigned long long frames = 0, framesOverBudget = 0, scaleChanges = 0;
+	};
+
+	/**
+	* get statistics of frame time and dynamic resolution
+	*/
+	DynamicResolutionStats getDynamicResolutionStats() {
+		DynamicResolutionStats stats;
+		stats.scale = Core::renderScale;
+		stats.frameTime = Core::lastFrameTime;
+		stats.averageFrameTime = Core::averageFrameTime;
+		stats.frames = Core::measuredFrames;
+		stats.framesOverBudget = Core::framesOverBudget;
+		stats.scaleChanges = Core::scaleChanges;
+		return stats;
+	}
+
+	/**
+	* check whether size of window is changed in this frame (by user, fullscreen or display change)
+	*/
+	bool windowResized() {
+		return Core::windowResized;
+	}
+
+	/**
+	* get size of drawing area of window in pixels (it is larger than window size on high-DPI displays)
+	* @param width width in pixels
+	* @param height height in pixels
+	*/
+	void getOutputSize(int &width, int &height) {
+		width = Core::outputWidth;
+		height = Core::outputHeight;
+	}
+
+	/**
+	* add darkening of corners to post-processing chain (effects run in order of adding, before beginHud)
+	* @param strength darkness at corners (0 to 1)
+	* @param radius distance from center where darkening starts (0 to 1)
+	*/
+	void addVignette(float strength = 0.5, float radius = 0.5) {
+		Core::PostEffect effect;
+		effect.kind = Core::PostEffectKind::Vignette;
+		effect.amount = std::max(0.0f, std::min(1.0f, strength));
+		effect.radius = std::max(0.0f, std::min(0.99f, radius));
+		Core::addPostEffect(effect);
+	}
+
+	/**
+	* add color grading to post-processing chain
+	* @param brightness value added to channels (-1 to 1)
+	* @param contrast contrast around middle gray (1 for no change)
+	* @param saturation saturation (0 for gray, 1 for no change, up to 2)
+	* @param r tint of red channel (255 for no change)
+	* @param g tint of green channel (255 for no change)
+	* @param b tint of blue channel (255 for no change)
+	*/
+	void addColorGrade(float brightness = 0, float contrast = 1, float saturation = 1,
+		Uint8 r = 255, Uint8 g = 255, Uint8 b = 255) {
+		Core::PostEffect effect;
+		effect.kind = Core::PostEffectKind::ColorGrade;
+		const Uint8 tints[3] = { b, g, r };
+		for (int c = 0; c < 3; c++)
+			for (int i = 0; i < 256; i++) {
+				float value = ((i / 255.0f - 0.5f) * contrast + 0.5f + brightness) * tints[c];
+				effect.tables[c][i] = Uint8(std::max(0.0f, std::min(255.0f, value + 0.5f)));
+			}
+		effect.saturation = Sint16(std::max(0.0f, std::min(2.0f, saturation)) * 64 + 0.5f);
+		Core::addPostEffect(effect);
+	}
+
+	/**
+	* add dark lines of CRT displays to post-processing chain
+	* @param darkness darkness of lines (0 to 1)
+	* @param spacing distance of lines in pixels of scene
+	*/
+	void addScanlines(float darkness = 0.3, int spacing = 2) {
+		Core::PostEffect effect;
+		effect.kind = Core::PostEffectKind::Scanlines;
+		effect.scale = Uint16((1 - std::max(0.0f, std::min(1.0f, darkness))) * 256 + 0.5f);
+		effect.spacing = std::max(1, spacing);
+		Core::addPostEffect(effect);
+	}
+
+	/**
+	* add glow around bright parts of scene to post-processing chain
+	* @param threshold brightness of channels which glows (0 to 255)
+	* @param radius radius of glow in pixels of scene
+	* @param strength strength of glow (0 to 1)
+	*/
+	void addBloom(int threshold = 200, int radius = 8, float strength = 0.6) {
+		Core::PostEffect effect;
+		effect.kind = Core::PostEffectKind::Bloom;
+		effect.threshold = std::max(0, std::min(255, threshold));
+		effect.blurRadius = std::max(1, std::min(128, radius / 2));
+		effect.scale = Uint16(std::max(0.0f, std::min(1.0f, strength)) * 256 + 0.5f);
+		Core::addPostEffect(effect);
+	}
+
+	/**
+	* remove all effects of post-processing chain
+	*/
+	void clearPostEffects() {
+		Core::flushGeometry();
+		Core::postEffects.clear();
+		Core::stopPostWorkers();
+		if (Core::postTexture != nullptr) {
+			SDL_DestroyTexture(Core::postTexture);
+			Core::postTexture = nullptr;
+		}
+		if (Core::sceneTarget != nullptr && Core::renderScale == 1)
+			Core::updateSceneTarget();
+	}
+
+	/**
+	* time of a part of post-processing in the last frame
+	*/
+	struct PostEffectTiming {
+		std::string name;
+		double milliseconds;
+	};
+
+	/**
+	* get time of reading the scene, each effect and uploading the result in the last frame
+	*/
+	std::vector<PostEffectTiming> getPostEffectTimings() {
+		static const char *names[] = { "vignette", "color grade", "scanlines", "bloom" };
+		std::vector<PostEffectTiming> timings;
+		if (Core::postEffects.empty())
+			return timings;
+		timings.push_back({ "read", Core::postReadTime });
+		for (const Core::PostEffect &effect : Core::postEffects)
+			timings.push_back({ names[int(effect.kind)], effect.time });
+		timings.push_back({ "upload", Core::postUploadTime });
+		return timings;
+	}
+
+	/**
+	* draw lights over the scene: each frame lights are drawn to a light map which multiplies the scene before HUD
+	* @param resolution size of light map for each unit of game coordinates (smaller is faster, 0.25 is a quarter)
+	* @param r red of ambient light
+	* @param g green of ambient light
+	* @param b blue of ambient light
+	* @return false if renderer can't draw to textures
+	*/
+	bool enableLighting(float resolution = 0.25, Uint8 r = 0, Uint8 g = 0, Uint8 b = 0) {
+		resolution = std::max(0.01f, std::min(1.0f, resolution));
+		int width = std::max(1, int(Core::logicalWidth * resolution + 0.5f));
+		int height = std::max(1, int(Core::logicalHeight * resolution + 0.5f));
+		Core::ambientLight = { r, g, b, 255 };
+		if (!Core::createLightFalloff())
+			return false;
+		if (Core::lightMap != nullptr && width == Core::lightMapWidth && height == Core::lightMapHeight)
+			return true;
+		Core::flushGeometry();
+		if (Core::lightMap != nullptr)
+			SDL_DestroyTexture(Core::lightMap);
+		Core::lightMap = SDL_CreateTexture(Core::renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+		if (Core::lightMap == nullptr)
+			return false;
+		Core::lightMapWidth = width;
+		Core::lightMapHeight = height;
+		SDL_SetTextureBlendMode(Core::lightMap, SDL_BLENDMODE_MOD);
+		SDL_SetTextureScaleMode(Core::lightMap, SDL_ScaleModeLinear);
+		return true;
+	}
+
+	/**
+	* stop drawing lights
+	*/
+	void disableLighting() {
+		if (Core::lightMap != nullptr) {
+			SDL_DestroyTexture(Core::lightMap);
+			Core::lightMap = nullptr;
+		}
+		Core::lightVertices.clear();
+		Core::lightIndices.clear();
+	}
+
+	/**
+	* change light of places without any light
+	* @param r red of ambient light
+	* @param g green of ambient light
+	* @param b blue of ambient light
+	*/
+	void setAmbientLight(Uint8 r, Uint8 g, Uint8 b) {
+		Core::ambientLight = { r, g, b, 255 };
+	}
+
+	/**
+	* add a light to this frame, lights out of screen are skipped
+	* @param x x of center of light
+	* @param y y of center of light
+	* @param radius radius of light
+	* @param r red of light
+	* @param g green of light
+	* @param b blue of light
+	* @param intensity brightness of light (0 to 1)
+	*/
+	void addLight(float x, float y, float radius, Uint8 r = 255, Uint8 g = 255, Uint8 b = 255, float intensity = 1) {
+		if (Core::lightMap == nullptr)
+			return;
+		if (radius <= 0 || intensity <= 0 || x + radius < 0 || y + radius < 0 || x - radius > Core::logicalWidth ||
+			y - radius > Core::logicalHeight) {
+			Core::queuedCulledLights++;
+			return;
+		}
+		intensity = std::min(1.0f, intensity);
+		SDL_Color color = { Uint8(r * intensity + 0.5f), Uint8(g * intensity + 0.5f), Uint8(b * intensity + 0.5f), 255 };
+		int first = int(Core::lightVertices.size());
+		Core::lightVertices.push_back({ { x - radius, y - radius }, color, { 0, 0 } });
+		Core::lightVertices.push_back({ { x + radius, y - radius }, color, { 1, 0 } });
+		Core::lightVertices.push_back({ { x + radius, y + radius }, color, { 1, 1 } });
+		Core::lightVertices.push_back({ { x - radius, y + radius }, color, { 0, 1 } });
+		for (int i : { 0, 1, 2, 0, 2, 3 })
+			Core::lightIndices.push_back(first + i);
+	}
+
+	/**
+	* get number of lights which are drawn and skipped in the last frame
+	* @param drawn number of drawn lights
+	* @param culled number of lights which are out of screen
+	*/
+	void getLightCounts(int &drawn, int &culled) {
+		drawn = Core::drawnLights;
+		culled = Core::culledLights;
+	}
+
+	/**
+	* wait a few milliseconds before continue process of application
+	* @param frameRate set the dalay (milisecond)
+	*/
+	void delay(Uint32 frameRate) {
+		SDL_Delay(frameRate);
+	}
+
+	/**
+	* load the font from a file
+	* @param path path of the font file to load
+	* @param size size of font
+	* @return font which is loaded
+	*/
+	Font *loadFont(const std::string &path, int size) {
+		return TTF_OpenFont(path.c_str(), size);
+	}
+
+	/**
+	* reload textures and sounds when their files are changed on disk (for development)
+	* files are decoded again in a background thread and replaced at the start of next frame
+	* only assets which are loaded after this call are watched; textures which change size are
+	* only reloaded if they are loaded with loadManagedTexture
+	* @return false if it is not supported on this platform
+	*/
+	bool enableHotReload() {
+#if defined(__linux__)
+		if (Core::hotReloadEnabled)
+			return true;
+		Core::hotReloadFile = inotify_init1(IN_CLOEXEC);
+		if (Core::hotReloadFile < 0)
+			return false;
+		if (pipe2(Core::hotReloadWake, O_CLOEXEC) != 0) {
+			close(Core::hotReloadFile);
+			Core::hotReloadFile = -1;
+			return false;
+		}
+		Core::hotReloadEnabled = true;
+		Core::hotReloadThread = std::thread(Core::watchFiles);
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	/**
+	* load the texture from a file on disk
+	* @param path path of the image file to load
+	* @param alpha transparency level
+	* @return texture which is loaded
+	*/
+	Texture loadTexture(const std::string &path, Uint8 alpha = 255) {
+		return Core::loadWatchedTexture(path, false, 0, 0, 0, alpha);
+	}
+
+	/**
+	* load the texture from a file on disk and replace transparency of image with specific color
+	* @param path path of the image file to load
+	* @param r red color
+	* @param g green color
+	* @param b blue color
+	* @param alpha transparency level
+	* @return texture which is loaded
+	*/
+	Texture loadTexture(const std::string &path, Uint8 r, Uint8 g, Uint8 b, Uint8 alpha = 255) {
+		return Core::loadWatchedTexture(path, true, r, g, b, alpha);
+	}
+
+	/**
+	* ways of mixing a texture with the pixels under it
+	*/
+	enum class BlendMode {
+		/**
+		* texture replaces pixels (fastest, used for images without transparent pixels)
+		*/
+		Opaque,
+
+		/**
+		* usual alpha blending (premultiplied alpha blending for textures which SBDL premultiplied)
+		*/
+		Alpha,
+
+		/**
+		* alpha blending of a texture which colors are premultiplied by alpha (even if SBDL did not premultiply them)
+		*/
+		Premultiplied,
+
+		/**
+		* texture is added to pixels (for glow, fire, light, etc.)
+		*/
+		Additive,
+
+		/**
+		* pixels are multiplied by texture (for shadows, tinting, etc.)
+		*/
+		Multiply
+	};
+
+	/**
+	* premultiply colors of textures which are loaded later by alpha
+	* premultiplied textures are filtered without dark fringes when they are scaled
+	* it has no effect if renderer doesn't support custom blend modes (e.g. software renderer)
+	* @param enable true to premultiply alpha
+	*/
+	void setPremultipliedAlpha(bool enable) {
+		Core::premultiplyAlpha = enable;
+	}
+
+	/**
+	* change blend mode of a texture
+	* loaded textures use BlendMode::Opaque if they have no transparent pixel, else BlendMode::Alpha
+	* (or BlendMode::Premultiplied if premultiplied alpha is enabled)
+	* @param texture the texture
+	* @param mode the new blend mode
+	*/
+	void setTextureBlendMode(const Texture &texture, BlendMode mode) {
+		// built-in blend mode which is used if renderer doesn't support the custom one
+		SDL_BlendMode fallback = SDL_BLENDMODE_BLEND;
+		switch (mode) {
+		case BlendMode::Opaque:
+			fallback = SDL_BLENDMODE_NONE;
+			break;
+		case BlendMode::Alpha:
+		case BlendMode::Premultiplied:
+			fallback = SDL_BLENDMODE_BLEND;
+			break;
+		case BlendMode::Additive:
+			fallback = SDL_BLENDMODE_ADD;
+			break;
+		case BlendMode::Multiply:
+			fallback = SDL_BLENDMODE_MUL;
+			break;
+		}
+		// premultiplied flag of a managed texture may be changed by reload
+		const bool premultiplied = Core::currentTexture(texture).premultiplied;
+		SDL_BlendMode blendMode = fallback;
+		if (mode == BlendMode::Premultiplied || (premultiplied && mode == BlendMode::Alpha))
+			blendMode = Core::premultipliedBlendMode();
+		else if (premultiplied && mode == BlendMode::Additive)
+			blendMode = SDL_ComposeCustomBlendMode(SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE, SDL_BLENDOPERATION_ADD,
+				SDL_BLENDFACTOR_ZERO, SDL_BLENDFACTOR_ONE, SDL_BLENDOPERATION_ADD);
+		else if (premultiplied && mode == BlendMode::Multiply)
+			blendMode = SDL_ComposeCustomBlendMode(SDL_BLENDFACTOR_DST_COLOR, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+				SDL_BLENDOPERATION_ADD, SDL_BLENDFACTOR_ZERO, SDL_BLENDFACTOR_ONE, SDL_BLENDOPERATION_ADD);
+		// batched draws of this texture must use the old blend mode
+		Core::flushGeometry();
+		SDL_Texture *underneathTexture = Core::underneath(texture);
+		if (underneathTexture == nullptr)
+			return;
+		if (SDL_SetTextureBlendMode(underneathTexture, blendMode) != 0) {
+			blendMode = fallback;
+			SDL_SetTextureBlendMode(underneathTexture, blendMode);
+		}
+		if (texture.managedIndex >= 0)
+			Core::managedTextures[texture.managedIndex].blendMode = blendMode;
+	}
+
+	/**
+	* load a managed texture from a file on disk
+	* managed textures are evicted when resident textures exceed the budget and are reloaded
+	* from the file when they are drawn again
+	* @param path path of the image file to load
+	* @param alpha transparency level
+	* @return texture which is loaded
+	* @see setTextureBudget
+	*/
+	Texture loadManagedTexture(const std::string &path, Uint8 alpha = 255) {
+		return Core::loadManagedTextureUnderneath(path, false, 0, 0, 0, alpha, Core::premultiplyAlpha);
+	}
+
+	/**
+	* load a managed texture from a file on disk and replace transparency of image with specific color
+	* @param path path of the image file to load
+	* @param r red color
+	* @param g green color
+	* @param b blue color
+	* @param alpha transparency level
+	* @return texture which is loaded
+	* @see loadManagedTexture
+	*/
+	Texture loadManagedTexture(const std::string &path, Uint8 r, Uint8 g, Uint8 b, Uint8 alpha = 255) {
+		return Core::loadManagedTextureUnderneath(path, true, r, g, b, alpha, Core::premultiplyAlpha);
+	}
+
+	/**
+	* set maximum memory of resident managed textures
+	* least recently drawn textures are evicted when the budget is exceeded
+	* @param bytes budget in bytes (0 means unlimited)
+	*/
+	void setTextureBudget(size_t bytes) {
+		Core::textureBudget = bytes;
+		Core::evictManagedTextures(-1);
+	}
+
+	/**
+	* get memory which is used by resident managed textures
+	* @return size in bytes
+	*/
+	size_t getResidentTextureBytes() {
+		return Core::residentTextureBytes;
+	}
+
+	/**
+	* get number of managed textures which are evicted since program was started
+	*/
+	unsigned int getTextureEvictions() {
+		return Core::textureEvictions;
+	}
+
+	/**
+	* get number of managed textures which are reloaded from disk since program was started
+	*/
+	unsigned int getTextureReloads() {
+		return Core::textureReloads;
+	}
+
+	/**
+	* pixels of a locked streaming texture in ARGB8888 format
+	* @see lockTexture
+	*/
+	struct PixelSpan {
+		/**
+		* first pixel of locked region
+		*/
+		Uint32 *pixels = nullptr;
+
+		/**
+		* distance between two rows in pixels
+		*/
+		int pitch = 0;
+
+		/**
+		* size of locked region
+		*/
+		int width = 0;
+		int height = 0;
+
+		/**
+		* pixel of locked region
+		* @param x position x inside the locked region
+		* @param y position y inside the locked region
+		*/
+		Uint32 &at(int x, int y) const {
+			return pixels[size_t(y) * pitch + x];
+		}
+
+		/**
+		* first pixel of a row of locked region
+		* @param y position y inside the locked region
+		*/
+		Uint32 *row(int y) const {
+			return pixels + size_t(y) * pitch;
+		}
+	};
+
+	/**
+	* convert a color to a pixel of streaming texture
+	* @param r red color
+	* @param g green color
+	* @param b blue color
+	* @param alpha transparency level
+	* @return pixel in ARGB8888 format
+	*/
+	Uint32 mapPixel(Uint8 r, Uint8 g, Uint8 b, Uint8 alpha = 255) {
+		return (Uint32(alpha) << 24) | (Uint32(r) << 16) | (Uint32(g) << 8) | Uint32(b);
+	}
+
+	/**
+	* create a texture which pixels can be changed in every frame (for minimaps, fog of war, effects, etc.)
+	* pixels are kept in memory and only changed regions are uploaded
+	* @param width width of texture
+	* @param height height of texture
+	* @param doubleBuffered true if uploads must go to a second texture which is not drawn in the current frame
+	* @return texture which is created (all pixels are transparent)
+	* @see lockTexture
+	*/
+	Texture createStreamingTexture(int width, int height, bool doubleBuffered = true) {
+		int index;
+		if (Core::freeStreamingSlots.empty()) {
+			index = int(Core::streamingTextures.size());
+			Core::streamingTextures.emplace_back();
+		}
+		else {
+			index = Core::freeStreamingSlots.back();
+			Core::freeStreamingSlots.pop_back();
+		}
+
+		Core::StreamingTexture &entry = Core::streamingTextures[index];
+		entry.used = true;
+		entry.doubleBuffered = doubleBuffered;
+		entry.width = width;
+		entry.height = height;
+		entry.pixels.assign(size_t(width) * height, 0);
+		for (int i = 0; i < (doubleBuffered ? 2 : 1); i++) {
+			entry.textures[i] = SDL_CreateTexture(Core::renderer, SDL_PIXELFORMAT_ARGB8888,
+				SDL_TEXTUREACCESS_STREAMING, width, height);
+			if (entry.textures[i] == nullptr) {
+				SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "SBDL create texture error",
+					"Unable to create streaming texture", nullptr);
+				exit(1);
+			}
+			SDL_SetTextureBlendMode(entry.textures[i], SDL_BLENDMODE_BLEND);
+		}
+		Core::commitStreamingTexture(index, { 0, 0, width, height });
+
+		Texture newTexture;
+		newTexture.width = width;
+		newTexture.height = height;
+		newTexture.streamingIndex = index;
+		return newTexture;
+	}
+
+	/**
+	* lock a region of streaming texture to change its pixels
+	* changes are shown after unlockTexture
+	* @param texture texture which is created by createStreamingTexture
+	* @param region region to lock (nullptr for whole texture)
+	* @return pixels of locked region
+	*/
+	PixelSpan lockTexture(const Texture &texture, const SDL_Rect *region = nullptr) {
+		Core::StreamingTexture &entry = Core::streamingTextures[texture.streamingIndex];
+		SDL_Rect bounds = { 0, 0, entry.width, entry.height };
+		if (region == nullptr || !SDL_IntersectRect(region, &bounds, &entry.locked))
+			entry.locked = region == nullptr ? bounds : SDL_Rect { 0, 0, 0, 0 };
+
+		PixelSpan span;
+		span.pixels = entry.pixels.data() + size_t(entry.locked.y) * entry.width + entry.locked.x;
+		span.pitch = entry.width;
+		span.width = entry.locked.w;
+		span.height = entry.locked.h;
+		return span;
+	}
+
+	/**
+	* unlock a streaming texture and upload the changed region
+	* @param texture texture which is locked by lockTexture
+	*/
+	void unlockTexture(const Texture &texture) {
+		Core::StreamingTexture &entry = Core::streamingTextures[texture.streamingIndex];
+		Core::commitStreamingTexture(texture.streamingIndex, entry.locked);
+		entry.locked = { 0, 0, 0, 0 };
+	}
+
+	/**
+	* replace pixels of a region of streaming texture
+	* @param texture texture which is created by createStreamingTexture
+	* @param region region to change
+	* @param pixels new pixels in ARGB8888 format
+	* @param pitch distance between two rows of pixels in pixels
+	*/
+	void updateTexture(const Texture &texture, const SDL_Rect &region, const Uint32 *pixels, int pitch) {
+		PixelSpan span = lockTexture(texture, &region);
+		const SDL_Rect &locked = Core::streamingTextures[texture.streamingIndex].locked;
+		const Uint32 *source = pixels + size_t(locked.y - region.y) * pitch + (locked.x - region.x);
+		for (int y = 0; y < span.height; y++)
+			std::copy(source + size_t(y) * pitch, source + size_t(y) * pitch + span.width, span.row(y));
+		unlockTexture(texture);
+	}
+
+	/**
+	* play sound
+	* multiple sound can play concurrently
+	* @param sound sound which is loaded before
+	* @param count frequency of sound (-1 to play all time)
+	* @see loadSound
+	*/
+	void playSound(Sound *sound, int count) {
+		if (count == 0)
+			return;
+		Core::MixerCommand command;
+		command.type = Core::MixerCommandType::PlayChannel;
+		command.sound = sound;
+		command.loops = (count > 0) ? count - 1 : -1;
+		Core::sendAudioCommand(command);
+	}
+
+	/**
+	* set position of listener of positional sounds (for example the player or center of camera)
+	* @param x position x
+	* @param y position y
+	* @see playSoundAt
+	*/
+	void setListenerPosition(int x, int y) {
+		Core::listenerX = float(x);
+		Core::listenerY = float(y);
+	}
+
+	/**
+	* set how positional sounds get quieter with distance from listener
+	* @param nearDistance sounds closer than this distance are played with full volume
+	* @param farDistance sounds farther than this distance are silent
+	* @param audibleVolume sounds quieter than this volume (0 to 1) are not played at all, so they don't use a channel
+	*/
+	void setSoundAttenuation(float nearDistance, float farDistance, float audibleVolume = 0.02f) {
+		Core::nearSoundDistance = nearDistance;
+		Core::farSoundDistance = std::max(farDistance, nearDistance + 1);
+		Core::audibleSoundVolume = audibleVolume;
+	}
+
+	/**
+	* play sound at a position of the world
+	* volume gets lower with distance from listener and sound is panned to the side of listener it comes from
+	* @param sound sound which is loaded before
+	* @param x position x of sound
+	* @param y position y of sound
+	* @param count frequency of sound (-1 to play all time)
+	* @return false if sound is too far to hear, so it is not played
+	* @see setListenerPosition
+	*/
+	bool playSoundAt(Sound *sound, int x, int y, int count = 1) {
+		if (count == 0)
+			return false;
+		float dx = x - Core::listenerX, dy = y - Core::listenerY;
+		float distance = std::sqrt(dx * dx + dy * dy);
+		float volume = 1 - (distance - Core::nearSoundDistance) / (Core::farSoundDistance - Core::nearSoundDistance);
+		volume = std::min(1.0f, volume);
+		if (volume * sound->volume / MIX_MAX_VOLUME < Core::audibleSoundVolume)
+			return false;
+
+		// equal power panning by horizontal direction of sound
+		float pan = distance > Core::nearSoundDistance ? dx / distance : dx / Core::nearSoundDistance;
+		float angle = (pan + 1) * float(M_PI) / 4;
+		float left = std::min(1.0f, volume * std::cos(angle) * float(M_SQRT2));
+		float right = std::min(1.0f, volume * std::sin(angle) * float(M_SQRT2));
+
+		Core::MixerCommand command;
+		command.type = Core::MixerCommandType::PlayChannel;
+		command.sound = sound;
+		command.loops = (count > 0) ? count - 1 : -1;
+		command.left = Uint8(255 * left);
+		command.right = Uint8(255 * right);
+		Core::sendAudioCommand(command);
+		return true;
+	}
+
+	/**
+	* buses of software mixer, volume of each bus can be changed separately
+	*/
+	enum class AudioBus { Sfx, Music, Voice };
+
+	/**
+	* start software mixer which plays hundreds of sounds in the audio thread, beside SDL_mixer channels
+	* functions of software mixer never wait for the audio thread
+	* @param maxVoices most sounds which can play at the same time
+	* @return false if the audio device doesn't use 16 bits stereo samples
+	* @see playMixerSound
+	*/
+	bool initMixer(int maxVoices = 256) {
+		int frequency, channels;
+		Uint16 format;
+		if (Core::mixerEnabled.load())
+			return true;
+		if (Mix_QuerySpec(&frequency, &format, &channels) == 0 || format != AUDIO_S16SYS || channels != 2)
+			return false;
+
+		Core::mixerVoices.resize(maxVoices);
+		for (std::vector<float> &buffer : Core::busBuffers)
+			buffer.assign(2 * Core::mixerBlockFrames, 0.0f);
+		Core::mixerFrequency = frequency;
+		for (Core::BusEffects &effects : Core::busEffects) {
+			for (int i = 0; i < 4; i++)
+				effects.combs[i].assign(std::max(1, Core::reverbCombLengths[i] * frequency / 44100), 0.0f);
+			for (int i = 0; i < 2; i++)
+				effects.allpasses[i].assign(std::max(1, Core::reverbAllpassLengths[i] * frequency / 44100), 0.0f);
+		}
+		// the audio thread uses voices and buffers after it sees this
+		Core::mixerEnabled.store(true, std::memory_order_release);
+		if (!Core::audioQueueEnabled)
+			Mix_SetPostMix(Core::postMix, nullptr);
+		return true;
+	}
+
+	/**
+	* play sound with software mixer
+	* @param sound sound which is loaded before
+	* @param bus bus of sound
+	* @param volume volume of sound (0 to 1)
+	* @param pan position of sound between left (-1) and right (1) speakers
+	* @param pitch playback speed (1 for normal speed)
+	* @param count frequency of sound (-1 to play all time)
+	* @return id of voice which plays the sound (0 if it can't be played)
+	*/
+	unsigned int playMixerSound(Sound *sound, AudioBus bus = AudioBus::Sfx, float volume = 1, float pan = 0,
+		float pitch = 1, int count = 1) {
+		if (!Core::mixerEnabled || count == 0)
+			return 0;
+		Core::MixerCommand command;
+		command.type = Core::MixerCommandType::Play;
+		command.voice = Core::nextVoiceId++;
+		if (Core::nextVoiceId == 0)
+			Core::nextVoiceId = 1;
+		command.sound = sound;
+		command.bus = int(bus);
+		command.volume = volume;
+		command.pan = pan;
+		command.pitch = pitch;
+		command.loops = (count > 0) ? count - 1 : -1;
+		return Core::sendMixerCommand(command) ? command.voice : 0;
+	}
+
+	/**
+	* change volume and pan of a sound which is played by software mixer
+	* @param voice id of voice which is returned by playMixerSound
+	* @param volume volume of sound (0 to 1)
+	* @param pan position of sound between left (-1) and right (1) speakers
+	*/
+	void setMixerSound(unsigned int voice, float volume, float pan = 0) {
+		Core::MixerCommand command;
+		command.type = Core::MixerCommandType::SetVoice;
+		command.voice = voice;
+		command.volume = volume;
+		command.pan = pan;
+		if (Core::mixerEnabled)
+			Core::sendMixerCommand(command);
+	}
+
+	/**
+	* stop a sound which is played by software mixer
+	* @param voice id of voice which is returned by playMixerSound
+	*/
+	void stopMixerSound(unsigned int voice) {
+		Core::MixerCommand command;
+		command.type = Core::MixerCommandType::Stop;
+		command.voice = voice;
+		if (Core::mixerEnabled)
+			Core::sendMixerCommand(command);
+	}
+
+	/**
+	* stop all sounds which are played by software mixer
+	*/
+	void stopAllMixerSounds() {
+		Core::MixerCommand command;
+		command.type = Core::MixerCommandType::StopAll;
+		if (Core::mixerEnabled)
+			Core::sendMixerCommand(command);
+	}
+
+	/**
+	* change volume of a bus of software mixer
+	* @param bus the bus
+	* @param volume volume of bus (0 to 1, more than 1 to amplify)
+	*/
+	void setBusVolume(AudioBus bus, float volume) {
+		Core::MixerCommand command;
+		command.type = Core::MixerCommandType::SetBusVolume;
+		command.bus = int(bus);
+		command.volume = volume;
+		if (Core::mixerEnabled)
+			Core::sendMixerCommand(command);
+	}
+
+	/**
+	* filter high frequencies of a bus of software mixer (e.g. for sounds behind a wall or under water)
+	* @param bus the bus
+	* @param cutoff cutoff frequency in Hz (0 to remove filter of bus)
+	* @param resonance Q of filter (0.707 for no peak at cutoff)
+	*/
+	void setBusLowPass(AudioBus bus, float cutoff, float resonance = 0.707f) {
+		Core::MixerCommand command;
+		command.type = Core::MixerCommandType::SetBusFilter;
+		command.bus = int(bus);
+		command.filter = Core::FilterKind::LowPass;
+		command.parameters[0] = cutoff;
+		command.parameters[1] = resonance;
+		if (Core::mixerEnabled)
+			Core::sendMixerCommand(command);
+	}
+
+	/**
+	* filter low frequencies of a bus of software mixer (e.g. for radio voices)
+	* @param bus the bus
+	* @param cutoff cutoff frequency in Hz (0 to remove filter of bus)
+	* @param resonance Q of filter (0.707 for no peak at cutoff)
+	*/
+	void setBusHighPass(AudioBus bus, float cutoff, float resonance = 0.707f) {
+		Core::MixerCommand command;
+		command.type = Core::MixerCommandType::SetBusFilter;
+		command.bus = int(bus);
+		command.filter = Core::FilterKind::HighPass;
+		command.parameters[0] = cutoff;
+		command.parameters[1] = resonance;
+		if (Core::mixerEnabled)
+			Core::sendMixerCommand(command);
+	}
+
+	/**
+	* add reverb to a bus of software mixer
+	* @param bus the bus
+	* @param wet volume of reverb (0 to remove reverb of bus)
+	* @param roomSize size of room (0 to 1), larger rooms have longer reverb
+	* @param damping damping of high frequencies of reverb (0 to 1)
+	*/
+	void setBusReverb(AudioBus bus, float wet, float roomSize = 0.5f, float damping = 0.5f) {
+		Core::MixerCommand command;
+		command.type = Core::MixerCommandType::SetBusReverb;
+		command.bus = int(bus);
+		command.parameters[0] = wet;
+		command.parameters[1] = roomSize;
+		command.parameters[2] = damping;
+		if (Core::mixerEnabled)
+			Core::sendMixerCommand(command);
+	}
+
+	/**
+	* lower music while sfx or voice bus of software mixer is loud (sidechain ducking)
+	* both music bus and music which is played by playMusic are ducked
+	* @param amount reduction of music volume (0 to disable ducking, 1 to silence music)
+	* @param threshold level of sfx and voice buses which starts ducking (0 to 1)
+	* @param attack time of lowering music in seconds
+	* @param release time of restoring music in seconds
+	*/
+	void setMusicDucking(float amount, float threshold = 0.05f, float attack = 0.01f, float release = 0.3f) {
+		Core::MixerCommand command;
+		command.type = Core::MixerCommandType::SetDucking;
+		command.parameters[0] = amount;
+		command.parameters[1] = threshold;
+		command.parameters[2] = attack;
+		command.parameters[3] = release;
+		if (Core::mixerEnabled)
+			Core::sendMixerCommand(command);
+	}
+
+	/**
+	* play music
+	* only one music file can play
+	* @param music music which is loaded before
+	* @param count frequency of msuic (-1 to play all time)
+	* @see loadMusic
+	*/
+	void playMusic(Music *music, int count) {
+		// music is opened and decoded here, not in the audio thread
+		Mix_PlayMusic(music, count);
+	}
+
+	/**
+	* keep sounds converted to the mixer format in a directory, so later runs load them without decoding
+	* and resampling (files are memory mapped where it is supported)
+	* cache files are named by hash of the source file and mixer format, so they are never stale
+	* @param directory an existing directory for cache files (empty to disable the cache)
+	*/
+	void setSoundCache(const std::string &directory) {
+		Core::soundCacheDirectory = directory;
+	}
+
+	/**
+	* load sound from a file in disk (use .wav)
+	* @param path path of the sound file to load
+	* @return sound which is loaded
+	*/
+	Sound *loadSound(const std::string &path) {
+		Sound *sound;
+		sound = Core::decodeSound(path);
+		if (!sound) {
+			const std::string message = "Unable to load: " + path;
+			SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "SBDL load sound error", message.c_str(), nullptr);
+			exit(1);
+		}
+		Core::HotReloadAsset asset;
+		asset.sound = sound;
+		Core::watchAsset(path, asset);
+		return sound;
+	}
+
+	/**
+	* load music from a file in disk (use .ogg or .wav)
+	* @param path path of the music file to load
+	* @return music which is loaded
+	*/
+	Music *loadMusic(const std::string &path) {
+		Music *music;
+		music = Mix_LoadMUS(path.c_str());
+		if (!music) {
+			const std::string message = "Unable to load: " + path;
+			SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "SBDL load music error", message.c_str(), nullptr);
+			exit(1);
+		}
+		return music;
+	}
+
+	/**
+	* stop music
+	*/
+	void stopMusic() {
+		Mix_HaltMusic();
+	}
+
+	/**
+	* stop all sounds
+	*/
+	void stopAllSounds() {
+		Core::MixerCommand command;
+		command.type = Core::MixerCommandType::HaltChannels;
+		Core::sendAudioCommand(command);
+	}
+
+	/**
+	* change volume of all sounds
+	* @param volume volume of sounds (0 to 128)
+	*/
+	void setSoundVolume(int volume) {
+		Core::MixerCommand command;
+		command.type = Core::MixerCommandType::ChannelVolume;
+		command.volume = float(volume);
+		Core::sendAudioCommand(command);
+	}
+
+	/**
+	* change volume of music
+	* @param volume volume of music (0 to 128)
+	*/
+	void setMusicVolume(int volume) {
+		Core::MixerCommand command;
+		command.type = Core::MixerCommandType::MusicVolume;
+		command.volume = float(volume);
+		Core::sendAudioCommand(command);
+	}
+
+	/**
+	* statistics of the audio thread, times are in milliseconds
+	*/
+	struct AudioStats {
+		/**
+		* number of audio callbacks and callbacks which came late (the device ran out of samples)
+		*/
+		unsigned long long callbacks = 0, underruns = 0;
+
+		/**
+		* duration of SBDL's part of audio callbacks (commands and software mixer, after SDL_mixer has
+		* mixed its channels and music, which is not counted) and longest time between two callbacks
+		*/
+		double averageCallbackTime = 0, maxCallbackTime = 0, maxCallbackInterval = 0;
+
+		/**
+		* number of sounds which are played and time from playSound to output of first sample (estimated)
+		*/
+		unsigned long long sounds = 0;
+		double averageLatency = 0, maxLatency = 0;
+
+		/**
+		* histograms of callback duration (SBDL's part) and latency, bucket i counts values from 2^i to 2^(i+1) microseconds
+		*/
+		unsigned long long callbackTimes[Core::audioHistogramBuckets] = {};
+		unsigned long long latencies[Core::audioHistogramBuckets] = {};
+
+		/**
+		* commands which wait for the audio thread now, most commands which waited for one callback,
+		* number of commands which found the queue full and number of them which are dropped
+		* (commands which only use SDL_mixer are done by the game thread instead)
+		*/
+		int queueDepth = 0, maxQueueDepth = 0;
+		unsigned long long queueFull = 0, droppedCommands = 0;
+
+		/**
+		* buffer size which audio device is opened with in sample frames and its duration
+		* (requested size until the first callback)
+		*/
+		int bufferSize = 0;
+		double bufferTime = 0;
+	};
+
+	/**
+	* get statistics of the audio thread, they are counted from start or last resetAudioStats
+	* @return the statistics
+	*/
+	AudioStats getAudioStats() {
+		AudioStats stats;
+		double milliseconds = 1000.0 / SDL_GetPerformanceFrequency();
+		stats.callbacks = Core::audioCallbacks.load(std::memory_order_relaxed);
+		stats.underruns = Core::audioUnderruns.load(std::memory_order_relaxed);
+		if (stats.callbacks != 0)
+			stats.averageCallbackTime = Core::callbackTicks.load(std::memory_order_relaxed) * milliseconds / stats.callbacks;
+		stats.maxCallbackTime = Core::maxCallbackTicks.load(std::memory_order_relaxed) * milliseconds;
+		stats.maxCallbackInterval = Core::maxCallbackInterval.load(std::memory_order_relaxed) * milliseconds;
+		stats.sounds = Core::playedSounds.load(std::memory_order_relaxed);
+		if (stats.sounds != 0)
+			stats.averageLatency = Core::latencyTicks.load(std::memory_order_relaxed) * milliseconds / stats.sounds;
+		stats.maxLatency = Core::maxLatencyTicks.load(std::memory_order_relaxed) * milliseconds;
+		for (int i = 0; i < Core::audioHistogramBuckets; i++) {
+			stats.callbackTimes[i] = Core::callbackHistogram[i].load(std::memory_order_relaxed);
+			stats.latencies[i] = Core::latencyHistogram[i].load(std::memory_order_relaxed);
+		}
+		stats.queueDepth = int(Core::mixerCommands.size());
+		stats.maxQueueDepth = Core::maxAudioQueueDepth.load(std::memory_order_relaxed);
+		stats.queueFull = Core::audioQueueFull;
+		stats.droppedCommands = Core::audioCommandsDropped;
+		stats.bufferSize = Core::audioBufferFrames.load(std::memory_order_relaxed);
+		if (stats.bufferSize == 0)
+			stats.bufferSize = Core::audioBufferSize;
+		stats.bufferTime = Core::audioBufferTicks.load(std::memory_order_relaxed) * milliseconds;
+		return stats;
+	}
+
+	/**
+	* start counting statistics of the audio thread again
+	*/
+	void resetAudioStats() {
+		Core::audioCallbacks = 0;
+		Core::audioUnderruns = 0;
+		Core::callbackTicks = 0;
+		Core::maxCallbackTicks = 0;
+		Core::maxCallbackInterval = 0;
+		Core::playedSounds = 0;
+		Core::latencyTicks = 0;
+		Core::maxLatencyTicks = 0;
+		for (int i = 0; i < Core::audioHistogramBuckets; i++) {
+			Core::callbackHistogram[i] = 0;
+			Core::latencyHistogram[i] = 0;
+		}
+		Core::maxAudioQueueDepth = 0;
+		Core::audioQueueFull = 0;
+		Core::audioCommandsDropped = 0;
+	}
+
+	/**
+	* free memory which is used for load sound from file
+	* @param sound Sound which you want to destroy
+	*/
+	void freeSound(Sound *sound) {
+		Core::forgetAsset(nullptr, -1, sound);
+		Core::freeChunkLater(sound);
+	}
+
+	/**
+	* free memory which is used for load music from file
+	* @param music Music which you want to destroy
+	*/
+	void freeMusic(Music *music) {
+		Mix_FreeMusic(music);
+	}
+
+	/**
+	* free memory which is used for load font from file
+	* @param font Font which you want to destroy
+	*/
+	void freeFont(Font *font) {
+		TTF_CloseFont(font);
+	}
+
+	/**
+	* free memory which is used for texture
+	* After call this function, texture is not usable anymore and any using has undefined behavior
+	* @param texture Texture which you want to destroy
+	*/
+	void freeTexture(Texture &texture) {
+		Core::flushGeometry();
+		if (texture.managedIndex >= 0) {
+			// a copy of a Texture which is freed before doesn't free the texture which uses its slot now
+			if (Core::managedTextures[texture.managedIndex].generation == texture.managedGeneration) {
+				Core::forgetAsset(nullptr, texture.managedIndex, nullptr);
+				Core::freeManagedTexture(texture.managedIndex);
+			}
+		}
+		else {
+			Core::forgetAsset(texture.underneathTexture, -1, nullptr);
+			if (texture.streamingIndex >= 0)
+				Core::freeStreamingTexture(texture.streamingIndex);
+			else
+				SDL_DestroyTexture(texture.underneathTexture);
+		}
+		texture.underneathTexture = nullptr;
+		texture.managedIndex = -1;
+		texture.streamingIndex = -1;
+		texture.width = 0;
+		texture.height = 0;
+	}
+
+	/**
+	* move-only owner of a resource pointer (Sound, Music or Font)
+	* resource is freed when the owner is destroyed or assigned, and it can be passed to
+	* every function which takes the raw pointer
+	*/
+	template <typename T, void (*Free)(T *)>
+	class Unique {
+	public:
+		Unique() = default;
+
+		/**
+		* take ownership of a resource
+		* @param resource resource which is loaded before (for example by loadSound)
+		*/
+		explicit Unique(T *resource) : resource(resource) {}
+
+		Unique(const Unique &) = delete;
+		Unique &operator=(const Unique &) = delete;
+
+		Unique(Unique &&other) noexcept : resource(other.release()) {}
+
+		Unique &operator=(Unique &&other) noexcept {
+			if (this != &other)
+				reset(other.release());
+			return *this;
+		}
+
+		~Unique() {
+			reset();
+		}
+
+		/**
+		* non-owning pointer to the resource
+		*/
+		T *get() const {
+			return resource;
+		}
+
+		operator T *() const {
+			return resource;
+		}
+
+		explicit operator bool() const {
+			return resource != nullptr;
+		}
+
+		/**
+		* give up ownership without freeing the resource
+		* @return the resource which was owned
+		*/
+		T *release() {
+			T *old = resource;
+			resource = nullptr;
+			return old;
+		}
+
+		/**
+		* free owned resource and take ownership of another one
+		* @param other the new resource
+		*/
+		void reset(T *other = nullptr) {
+			if (resource != nullptr && !Core::quitted)
+				Free(resource);
+			resource = other;
+		}
+
+	private:
+		T *resource = nullptr;
+	};
+
+	/**
+	* owning handle of a Sound
+	*/
+	using UniqueSound = Unique<Sound, freeSound>;
+
+	/**
+	* owning handle of a Music
+	*/
+	using UniqueMusic = Unique<Music, freeMusic>;
+
+	/**
+	* owning handle of a Font
+	*/
+	using UniqueFont = Unique<Font, freeFont>;
+
+	/**
+	* move-only owner of a Texture
+	* texture is freed when the owner is destroyed or assigned, and it can be passed to
+	* every function which takes a Texture (the Texture itself is a cheap non-owning view)
+	*/
+	class UniqueTexture {
+	public:
+		UniqueTexture() = default;
+
+		/**
+		* take ownership of a texture
+		* @param texture texture which is loaded or created before
+		*/
+		explicit UniqueTexture(const Texture &texture) : texture(texture) {}
+
+		UniqueTexture(const UniqueTexture &) = delete;
+		UniqueTexture &operator=(const UniqueTexture &) = delete;
+
+		UniqueTexture(UniqueTexture &&other) noexcept : texture(other.release()) {}
+
+		UniqueTexture &operator=(UniqueTexture &&other) noexcept {
+			if (this != &other)
+				reset(other.release());
+			return *this;
+		}
+
+		~UniqueTexture() {
+			reset();
+		}
+
+		/**
+		* non-owning view of the texture
+		*/
+		const Texture &get() const {
+			return texture;
+		}
+
+		operator const Texture &() const {
+			return texture;
+		}
+
+		const Texture *operator->() const {
+			return &texture;
+		}
+
+		explicit operator bool() const {
+			return texture.underneathTexture != nullptr || texture.managedIndex >= 0 || texture.streamingIndex >= 0;
+		}
+
+		/**
+		* give up ownership without freeing the texture
+		* @return the texture which was owned
+		*/
+		Texture release() {
+			Texture old = texture;
+			texture = Texture();
+			return old;
+		}
+
+		/**
+		* free owned texture and take ownership of another one
+		* @param other the new texture
+		*/
+		void reset(const Texture &other = Texture()) {
+			if (*this && !Core::quitted)
+				freeTexture(texture);
+			texture = other;
+		}
+
+	private:
+		Texture texture;
+	};
+
+	/**
+	* texture showed in render screen in position destRect with angle and flip
+	* @param texture the source texture
+	* @param angle an angle in degrees that indicates the rotation that will be applied to texture, rotating it in a clockwise direction around center of texture
+	* @param destRect custom rect to draw texture
+	* @param flip flipping actions performed on the texture (SDL_FLIP_NONE or SDL_FLIP_HORIZONTAL or SDL_FLIP_VERTICAL)
+	*/
+	void showTexture(const Texture &texture, double angle, const SDL_Rect &destRect,
+		SDL_RendererFlip flip = SDL_FLIP_NONE) {
+		SDL_Texture *underneathTexture = Core::underneath(texture);
+		if (underneathTexture == nullptr)
+			return;
+		Core::flushGeometry();
+		SDL_RenderCopyEx(Core::renderer, underneathTexture, nullptr, &destRect, angle, nullptr, flip);
+	}
+
+	/**
+	* texture showed in render screen in position texture.rect with angle and flip
+	* @param texture the source texture
+	* @param x position x
+	* @param y position y
+	* @param angle an angle in degrees that indicates the rotation that will be applied to texture, rotating it
+	in a clockwise direction around center of texture
+	* @param flip flipping actions performed on the texture (SDL_FLIP_NONE or SDL_FLIP_HORIZONTAL or SDL_FLIP_VERTICAL)
+	*/
+	void showTexture(const Texture &texture, int x, int y, double angle, SDL_RendererFlip flip = SDL_FLIP_NONE) {
+		const Texture current = Core::currentTexture(texture);
+		SDL_Rect rect;
+		rect.x = x;
+		rect.y = y;
+		rect.w = current.width;
+		rect.h = current.height;
+		showTexture(texture, angle, rect, flip);
+	}
+
+	/**
+	* texture showed in render screen in position destRect
+	* @param texture the source texture
+	* @param destRect custom rect to draw texture
+	*/
+	void showTexture(const Texture &texture, const SDL_Rect &destRect) {
+		SDL_Texture *underneathTexture = Core::underneath(texture);
+		if (underneathTexture == nullptr)
+			return;
+		Core::flushGeometry();
+		SDL_RenderCopy(Core::renderer, underneathTexture, nullptr, &destRect);
+	}
+
+	/**
+	* texture showed in render screen in position texture.rect
+	* @param texture the source texture
+	* @param x position x
+	* @param y position y
+	*/
+	void showTexture(const Texture &texture, int x, int y) {
+		const Texture current = Core::currentTexture(texture);
+		SDL_Rect rect;
+		rect.x = x;
+		rect.y = y;
+		rect.w = current.width;
+		rect.h = current.height;
+		showTexture(texture, rect);
+	}
+
+	/**
+	* texture showed in render screen in position destRect with a tint, angle and flip
+	* tint is applied per draw (texture is not changed), so consecutive draws of a texture with different
+	* tints are drawn together in one call
+	* @param texture the source texture
+	* @param destRect custom rect to draw texture
+	* @param tint color and transparency multiplied with texture (use alpha of tint to fade)
+	* @param angle an angle in degrees that indicates the rotation that will be applied to texture, rotating it in a clockwise direction around center of texture
+	* @param flip flipping actions performed on the texture (SDL_FLIP_NONE or SDL_FLIP_HORIZONTAL or SDL_FLIP_VERTICAL)
+	*/
+	void showTexture(const Texture &texture, const SDL_Rect &destRect, SDL_Color tint, double angle = 0,
+		SDL_RendererFlip flip = SDL_FLIP_NONE) {
+		float u1 = 0, v1 = 0, u2 = 1, v2 = 1;
+		if (flip & SDL_FLIP_HORIZONTAL)
+			std::swap(u1, u2);
+		if (flip & SDL_FLIP_VERTICAL)
+			std::swap(v1, v2);
+
+		float centerX = destRect.x + destRect.w / 2.0f, centerY = destRect.y + destRect.h / 2.0f;
+		float halfW = destRect.w / 2.0f, halfH = destRect.h / 2.0f;
+		float radian = float(angle * M_PI / 180), cosine = std::cos(radian), sine = std::sin(radian);
+		const float offsets[4][2] = { { -halfW, -halfH }, { halfW, -halfH }, { halfW, halfH }, { -halfW, halfH } };
+		SDL_FPoint corners[4];
+		for (int i = 0; i < 4; i++) {
+			corners[i].x = centerX + offsets[i][0] * cosine - offsets[i][1] * sine;
+			corners[i].y = centerY + offsets[i][0] * sine + offsets[i][1] * cosine;
+		}
+
+		if (Core::batchTexture(texture, tint))
+			Core::pushQuad(corners, u1, v1, u2, v2, tint);
+	}
+
+	/**
+	* texture showed in render screen in position x and y with a tint, angle and flip
+	* @param texture the source texture
+	* @param x position x
+	* @param y position y
+	* @param tint color and transparency multiplied with texture (use alpha of tint to fade)
+	* @param angle an angle in degrees that indicates the rotation that will be applied to texture, rotating it in a clockwise direction around center of texture
+	* @param flip flipping actions performed on the texture (SDL_FLIP_NONE or SDL_FLIP_HORIZONTAL or SDL_FLIP_VERTICAL)
+	*/
+	void showTexture(const Texture &texture, int x, int y, SDL_Color tint, double angle = 0,
+		SDL_RendererFlip flip = SDL_FLIP_NONE) {
+		const Texture current = Core::currentTexture(texture);
+		SDL_Rect rect = { x, y, current.width, current.height };
+		showTexture(texture, rect, tint, angle, flip);
+	}
+
+	/**
+	* texture showed in render screen as a nine-slice panel in destRect with one draw call
+	* corners keep their size, edges are stretched along one axis and center is stretched along both axes
+	* @param texture the source texture
+	* @param destRect custom rect to draw texture
+	* @param left width of left border in texture
+	* @param top height of top border in texture
+	* @param right width of right border in texture
+	* @param bottom height of bottom border in texture
+	* @param tint color and transparency multiplied with texture
+	*/
+	void showTextureNineSlice(const Texture &texture, const SDL_Rect &destRect, int left, int top, int right,
+		int bottom, SDL_Color tint = { 255, 255, 255, 255 }) {
+		// borders are shrunk if destRect is smaller than them
+		float scaleX = std::min(1.0f, float(destRect.w) / std::max(1, left + right));
+		float scaleY = std::min(1.0f, float(destRect.h) / std::max(1, top + bottom));
+		const float x[4] = { float(destRect.x), destRect.x + left * scaleX,
+			destRect.x + destRect.w - right * scaleX, float(destRect.x + destRect.w) };
+		const float y[4] = { float(destRect.y), destRect.y + top * scaleY,
+			destRect.y + destRect.h - bottom * scaleY, float(destRect.y + destRect.h) };
+		if (!Core::batchTexture(texture, tint))
+			return;
+		const Texture current = Core::currentTexture(texture);
+		const float u[4] = { 0, float(left) / current.width, float(current.width - right) / current.width, 1 };
+		const float v[4] = { 0, float(top) / current.height, float(current.height - bottom) / current.height, 1 };
+		for (int row = 0; row < 3; row++)
+			for (int column = 0; column < 3; column++)
+				if (x[column] < x[column + 1] && y[row] < y[row + 1])
+					Core::pushQuad(x[column], y[row], x[column + 1], y[row + 1], u[column], v[row], u[column + 1],
+						v[row + 1], tint);
+	}
+
+	/**
+	* texture showed in render screen repeatedly to fill destRect with one draw call
+	* tiles on right and bottom edges are cut if they don't fit
+	* @param texture the source texture
+	* @param destRect custom rect to fill
+	* @param tileWidth width of each tile (0 for width of texture)
+	* @param tileHeight height of each tile (0 for height of texture)
+	* @param tint color and transparency multiplied with texture
+	*/
+	void showTextureTiled(const Texture &texture, const SDL_Rect &destRect, int tileWidth = 0, int tileHeight = 0,
+		SDL_Color tint = { 255, 255, 255, 255 }) {
+		const Texture current = Core::currentTexture(texture);
+		if (tileWidth <= 0)
+			tileWidth = current.width;
+		if (tileHeight <= 0)
+			tileHeight = current.height;
+		if (tileWidth <= 0 || tileHeight <= 0)
+			return;
+
+		if (!Core::batchTexture(texture, tint))
+			return;
+		for (int y = 0; y < destRect.h; y += tileHeight) {
+			int h = std::min(tileHeight, destRect.h - y);
+			for (int x = 0; x < destRect.w; x += tileWidth) {
+				int w = std::min(tileWidth, destRect.w - x);
+				Core::pushQuad(float(destRect.x + x), float(destRect.y + y), float(destRect.x + x + w),
+					float(destRect.y + y + h), 0, 0, float(w) / tileWidth, float(h) / tileHeight, tint);
+			}
+		}
+	}
+
+	/**
+	* create a texture from a font for a special string with specific color whcih can be drawed in render window
+	* @param font font which is loaded
+	* @param text text that convert to texture
+	* @param r red color
+	* @param g green color
+	* @param b blue color
+	* @return texture which created with that font and text
+	*/
+	Texture createFontTexture(Font *font, const std::string &text, Uint8 r, Uint8 g, Uint8 b) {
+		SDL_Color color;
+		color.r = r;
+		color.g = g;
+		color.b = b;
+		SDL_Surface *temp = TTF_RenderText_Solid(font, text.c_str(), color);
+
+		Texture newTexture;
+		newTexture.underneathTexture = SDL_CreateTextureFromSurface(Core::renderer, temp);
+		newTexture.width = temp->w;
+		newTexture.height = temp->h;
+
+		SDL_FreeSurface(temp);
+		return newTexture;
+	}
+
+	/**
+	* check intersection of two SDL_Rect
+	* @param firstRect first rectangle
+	* @param secondRect second rectangle
+	* @return true if has intersection
+	*/
+	bool hasIntersectionRect(const SDL_Rect &firstRect, const SDL_Rect &secondRect) {
+		return SDL_HasIntersection(&firstRect, &secondRect) == SDL_TRUE;
+	}
+
+	/**
+	* Draw rectangle on renderer screen.
+	* @param rect rectangle position
+	* @param r red color
+	* @param g green color
+	* @param b blue color
+	* @param alpha transparency
+	*/
+	void drawRectangle(const SDL_Rect &rect, Uint8 r, Uint8 g, Uint8 b, Uint8 alpha = 255) {
+		Core::flushGeometry();
+		Uint8 defaults[4];
+		SDL_GetRenderDrawColor(Core::renderer, &defaults[0], &defaults[1], &defaults[2], &defaults[3]);
+		SDL_SetRenderDrawColor(Core::renderer, r, g, b, alpha);
+		SDL_RenderFillRect(Core::renderer, &rect);
+		SDL_SetRenderDrawColor(Core::renderer, defaults[0], defaults[1], defaults[2], defaults[3]);
+	}
+
+	/**
+	* Check if a point is inside a Rect
+	* @param x
+	* @param y
+	* @param rect the rectangle to check with
+	* @return true if point is inside the rectangle
+	*/
+	bool pointInRect(int x, int y, const SDL_Rect &rect) {
+		SDL_Point point;
+		point.x = x;
+		point.y = y;
+		return SDL_PointInRect(&point, &rect) == SDL_TRUE;
+	}
+
+	/**
+	* Check if mouse is inside a rect
+	* @param rect check when mouse is inside this rectangle
+	* @return true if mouse is inside the rectangle
+	*/
+	bool mouseInRect(const SDL_Rect &rect) {
+		return pointInRect(Mouse.x, Mouse.y, rect);
+	}
+
+	/**
+	* read a manifest which lists assets in groups, so a whole group can be loaded or freed with one call
+	* each line of manifest is one of these (lines which start with # are ignored):
+	* group <name>
+	* texture <id> <path> [alpha <a>] [colorkey <r> <g> <b>] [managed]
+	* sound <id> <path>
+	* music <id> <path>
+	* font <id> <path> <size>
+	* nothing is loaded until loadGroup or loadScene is called
+	* @param path path of the manifest file
+	*/
+	void loadManifest(const std::string &path) {
+		std::ifstream file(path);
+		if (!file)
+			Core::manifestError("Missing manifest file: " + path);
+
+		std::string line, group;
+		int lineNumber = 0;
+		while (std::getline(file, line)) {
+			lineNumber++;
+			std::istringstream words(line);
+			std::string kind, id;
+			if (!(words >> kind) || kind[0] == '#')
+				continue;
+			const std::string where = path + ":" + std::to_string(lineNumber);
+			if (kind == "group") {
+				if (!(words >> group))
+					Core::manifestError("Missing group name at " + where);
+				Core::manifestGroups[group];
+				continue;
+			}
+
+			Core::ManifestAsset asset;
+			if (kind == "texture")
+				asset.kind = Core::AssetKind::Texture;
+			else if (kind == "sound")
+				asset.kind = Core::AssetKind::Sound;
+			else if (kind == "music")
+				asset.kind = Core::AssetKind::Music;
+			else if (kind == "font")
+				asset.kind = Core::AssetKind::Font;
+			else
+				Core::manifestError("Unknown asset kind '" + kind + "' at " + where);
+			if (group.empty())
+				Core::manifestError("Asset is not in a group at " + where);
+			if (!(words >> id >> asset.path))
+				Core::manifestError("Missing id or path at " + where);
+			if (asset.kind == Core::AssetKind::Font && !(words >> asset.size))
+				Core::manifestError("Missing font size at " + where);
+
+			std::string option;
+			while (asset.kind == Core::AssetKind::Texture && words >> option) {
+				int r, g, b, alpha;
+				if (option == "alpha" && words >> alpha)
+					asset.alpha = Uint8(alpha);
+				else if (option == "colorkey" && words >> r >> g >> b) {
+					asset.changeColor = true;
+					asset.r = Uint8(r);
+					asset.g = Uint8(g);
+					asset.b = Uint8(b);
+				}
+				else if (option == "managed")
+					asset.managed = true;
+				else
+					Core::manifestError("Bad texture option '" + option + "' at " + where);
+			}
+
+			int index = -1;
+			for (size_t i = 0; i < Core::manifestAssets.size() && index < 0; i++)
+				if (Core::manifestAssets[i].sameAs(asset))
+					index = int(i);
+			if (index < 0) {
+				index = int(Core::manifestAssets.size());
+				Core::manifestAssets.push_back(asset);
+			}
+			std::map<std::string, int>::const_iterator found = Core::manifestIds.find(id);
+			if (found != Core::manifestIds.end() && found->second != index)
+				Core::manifestError("Asset " + id + " is defined twice at " + where);
+			Core::manifestIds[id] = index;
+
+			std::vector<int> &assets = Core::manifestGroups[group];
+			if (std::find(assets.begin(), assets.end(), index) == assets.end())
+				assets.push_back(index);
+		}
+	}
+
+	/**
+	* load all assets of a group in a manifest
+	* images, sounds and music are decoded in parallel threads, and assets which are loaded by other
+	* groups are not loaded again
+	* @param group name of the group
+	* @param progress function which is called after each asset with number of loaded assets and all assets
+	* @see loadManifest
+	*/
+	void loadGroup(const std::string &group, const std::function<void(int, int)> &progress = nullptr) {
+		std::map<std::string, std::vector<int>>::const_iterator found = Core::manifestGroups.find(group);
+		if (found == Core::manifestGroups.end())
+			Core::manifestError("Unknown group: " + group);
+		if (std::find(Core::loadedGroups.begin(), Core::loadedGroups.end(), group) != Core::loadedGroups.end())
+			return;
+		Core::loadedGroups.push_back(group);
+
+		std::vector<Core::LoadJob> jobs;
+		for (int index : found->second)
+			if (Core::manifestAssets[index].references++ == 0 && !Core::manifestAssets[index].loaded()) {
+				Core::LoadJob job;
+				job.asset = index;
+				jobs.push_back(job);
+			}
+
+		// loader threads decode files in order, the main thread uploads them as soon as they are ready
+		std::mutex mutex;
+		std::condition_variable readyChanged;
+		std::atomic<size_t> nextJob(0);
+		std::vector<std::thread> loaders;
+		unsigned int threads = std::max(1u, std::min(std::thread::hardware_concurrency(), unsigned(jobs.size())));
+		for (unsigned int i = 0; i < threads && !jobs.empty(); i++)
+			loaders.emplace_back([&]() {
+			for (size_t next; (next = nextJob++) < jobs.size();) {
+				Core::LoadJob &job = jobs[next];
+				const Core::ManifestAsset &asset = Core::manifestAssets[job.asset];
+				if (asset.kind == Core::AssetKind::Texture && !asset.managed)
+					job.surface = Core::decodeImage(asset.path, asset.changeColor, asset.r, asset.g, asset.b,
+						asset.alpha, Core::premultiplyAlpha, job.opaque);
+				else if (asset.kind == Core::AssetKind::Sound)
+					job.sound = Core::decodeSound(asset.path);
+				else if (asset.kind == Core::AssetKind::Music)
+					job.music = Mix_LoadMUS(asset.path.c_str());
+
+				std::lock_guard<std::mutex> lock(mutex);
+				job.ready = true;
+				readyChanged.notify_all();
+			}
+		});
+
+		int loaded = 0;
+		for (Core::LoadJob &job : jobs) {
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				readyChanged.wait(lock, [&]() { return job.ready; });
+			}
+			Core::ManifestAsset &asset = Core::manifestAssets[job.asset];
+			switch (asset.kind) {
+			case Core::AssetKind::Texture:
+				if (asset.managed) {
+					asset.texture = asset.changeColor ? loadManagedTexture(asset.path, asset.r, asset.g, asset.b,
+						asset.alpha) : loadManagedTexture(asset.path, asset.alpha);
+					break;
+				}
+				if (job.surface == nullptr)
+					Core::manifestError("Missing Image file: " + asset.path);
+				asset.texture = Core::uploadImage(job.surface, job.opaque, Core::premultiplyAlpha);
+				SDL_FreeSurface(job.surface);
+				Core::watchTexture(asset.path, asset.changeColor, asset.r, asset.g, asset.b, asset.alpha,
+					Core::premultiplyAlpha, asset.texture.underneathTexture, -1);
+				break;
+			case Core::AssetKind::Sound:
+				if (job.sound == nullptr)
+					Core::manifestError("Unable to load: " + asset.path);
+				asset.sound = job.sound;
+				{
+					Core::HotReloadAsset watched;
+					watched.sound = asset.sound;
+					Core::watchAsset(asset.path, watched);
+				}
+				break;
+			case Core::AssetKind::Music:
+				if (job.music == nullptr)
+					Core::manifestError("Unable to load: " + asset.path);
+				asset.music = job.music;
+				break;
+			case Core::AssetKind::Font:
+				// fonts are opened here because SDL_ttf is not thread safe
+				asset.font = loadFont(asset.path, asset.size);
+				if (asset.font == nullptr)
+					Core::manifestError("Unable to load: " + asset.path);
+				break;
+			}
+			if (progress)
+				progress(++loaded, int(jobs.size()));
+		}
+		for (std::thread &loader : loaders)
+			loader.join();
+	}
+
+	/**
+	* free all assets of a group which are not used by another loaded group
+	* @param group name of the group
+	*/
+	void unloadGroup(const std::string &group) {
+		std::vector<std::string>::iterator loaded = std::find(Core::loadedGroups.begin(), Core::loadedGroups.end(),
+			group);
+		if (loaded == Core::loadedGroups.end())
+			return;
+		Core::loadedGroups.erase(loaded);
+
+		for (int index : Core::manifestGroups[group]) {
+			Core::ManifestAsset &asset = Core::manifestAssets[index];
+			if (--asset.references > 0)
+				continue;
+			if (asset.texture.underneathTexture != nullptr || asset.texture.managedIndex >= 0)
+				freeTexture(asset.texture);
+			if (asset.sound != nullptr)
+				freeSound(asset.sound);
+			if (asset.music != nullptr)
+				freeMusic(asset.music);
+			if (asset.font != nullptr)
+				freeFont(asset.font);
+			asset.sound = nullptr;
+			asset.music = nullptr;
+			asset.font = nullptr;
+		}
+	}
+
+	/**
+	* change scene: load a group and free every other loaded group
+	* assets which are shared with the new group are kept
+	* @param group name of the group
+	* @param progress function which is called after each asset with number of loaded assets and all assets
+	*/
+	void loadScene(const std::string &group, const std::function<void(int, int)> &progress = nullptr) {
+		std::map<std::string, std::vector<int>>::const_iterator found = Core::manifestGroups.find(group);
+		if (found == Core::manifestGroups.end())
+			Core::manifestError("Unknown group: " + group);
+
+		// keep shared assets alive while old groups are freed
+		for (int index : found->second)
+			Core::manifestAssets[index].references++;
+		std::vector<std::string> oldGroups = Core::loadedGroups;
+		for (const std::string &oldGroup : oldGroups)
+			if (oldGroup != group)
+				unloadGroup(oldGroup);
+		for (int index : found->second)
+			Core::manifestAssets[index].references--;
+
+		loadGroup(group, progress);
+	}
+
+	/**
+	* get a texture of a loaded group
+	* @param id id of texture in manifest
+	*/
+	Texture getTexture(const std::string &id) {
+		return Core::findAsset(id, Core::AssetKind::Texture).texture;
+	}
+
+	/**
+	* get a sound of a loaded group
+	* @param id id of sound in manifest
+	*/
+	Sound *getSound(const std::string &id) {
+		return Core::findAsset(id, Core::AssetKind::Sound).sound;
+	}
+
+	/**
+	* get a music of a loaded group
+	* @param id id of music in manifest
+	*/
+	Music *getMusic(const std::string &id) {
+		return Core::findAsset(id, Core::AssetKind::Music).music;
+	}
+
+	/**
+	* get a font of a loaded group
+	* @param id id of font in manifest
+	*/
+	Font *getFont(const std::string &id) {
+		return Core::findAsset(id, Core::AssetKind::Font).font;
+	}
+
+	/**
+	* write game state to a compact binary file
+	* values are written in the byte order of machine, arrays are aligned, so BinaryReader can use them in place
+	* textures, sounds and music are written by their id in manifest
+	* @see BinaryReader
+	*/
+	class BinaryWriter {
+	public:
+		/**
+		* start a new file
+		* @param version version of game data, it can be checked by reader
+		* @param reserve number of bytes which are allocated at start
+		*/
+		explicit BinaryWriter(Uint32 version = 0, size_t reserve = 1 << 16) : version(version) {
+			bytes.reserve(reserve);
+			start();
+		}
+
+		/**
+		* write a value of a type which can be copied with memcpy (numbers, SDL_Rect, SDL_Color, plain structs)
+		*/
+		template <typename T>
+		void write(const T &value) {
+			static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable types can be written");
+			append(&value, sizeof(T));
+		}
+
+		/**
+		* write a string
+		*/
+		void write(const std::string &value) {
+			write(Uint32(value.size()));
+			append(value.data(), value.size());
+		}
+
+		/**
+		* write an array of values which can be copied with memcpy in one copy
+		* @param items first item
+		* @param count number of items
+		*/
+		template <typename T>
+		void writeArray(const T *items, size_t count) {
+			static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable types can be written");
+			write(Uint64(count));
+			bytes.resize((bytes.size() + Core::saveAlignment - 1) / Core::saveAlignment * Core::saveAlignment, 0);
+			append(items, count * sizeof(T));
+		}
+
+		template <typename T>
+		void writeArray(const std::vector<T> &items) {
+			writeArray(items.data(), items.size());
+		}
+
+		/**
+		* write a texture of a loaded manifest group by its id (textures which are not in manifests are written as empty)
+		*/
+		void write(const Texture &texture) {
+			writeAsset(Core::AssetKey(texture.underneathTexture, texture.managedIndex));
+		}
+
+		/**
+		* write a sound or music of a loaded manifest group by its id
+		*/
+		void write(Sound *sound) {
+			writeAsset(Core::AssetKey(sound, -1));
+		}
+
+		void write(Music *music) {
+			writeAsset(Core::AssetKey(music, -1));
+		}
+
+		/**
+		* get all bytes of file and start a new file
+		* @return the bytes
+		*/
+		std::vector<char> release() {
+			finish();
+			std::vector<char> result;
+			result.swap(bytes);
+			bytes.reserve(result.size());
+			restart();
+			return result;
+		}
+
+		/**
+		* write file to disk, the old file is kept if writing fails
+		* the writer starts a new file after it and keeps its memory for the next file
+		* @param path path of file
+		* @return true if file is written
+		*/
+		bool save(const std::string &path) {
+			finish();
+			bool written = Core::writeFileAtomic(path, bytes);
+			restart();
+			return written;
+		}
+
+		/**
+		* write file to disk in a background thread, the game continues while the file is written
+		* the writer starts a new file after it
+		* @param path path of file
+		* @see waitForSaves
+		*/
+		void saveAsync(const std::string &path) {
+			finish();
+			std::vector<char> *file = new std::vector<char>();
+			file->swap(bytes);
+			bytes = Core::takeSaveBuffer();
+			bytes.reserve(file->size());
+			restart();
+
+			Core::pendingSaves++;
+			std::thread([path, file]() {
+				if (!Core::writeFileAtomic(path, *file))
+					Core::failedSaves++;
+				Core::recycleSaveBuffer(*file);
+				delete file;
+				Core::pendingSaves--;
+			}).detach();
+		}
+
+	private:
+		/**
+		* version of game data
+		*/
+		Uint32 version;
+
+		/**
+		* bytes of file
+		*/
+		std::vector<char> bytes;
+
+		/**
+		* ids of written assets and their index in table of file
+		*/
+		std::map<Core::AssetKey, Uint32> assetIndices;
+		std::vector<std::string> assetIds;
+
+		/**
+		* map from assets to their id (it is made once, when the first asset is written)
+		*/
+		std::map<Core::AssetKey, std::string> manifestIds;
+
+		/**
+		* write header of a new file
+		*/
+		void start() {
+			Core::SaveHeader header = {};
+			std::memcpy(header.magic, "SBSV", 4);
+			header.formatVersion = Core::saveFormatVersion;
+			header.version = version;
+			header.byteOrder = Core::saveByteOrder;
+			append(&header, sizeof(header));
+		}
+
+		/**
+		* write table of asset ids at end of file and complete header
+		*/
+		void finish() {
+			Uint64 assetsOffset = bytes.size();
+			write(Uint32(assetIds.size()));
+			for (const std::string &id : assetIds)
+				write(id);
+			Core::SaveHeader *header = (Core::SaveHeader *)bytes.data();
+			header->assetsOffset = assetsOffset;
+			header->size = bytes.size();
+		}
+
+		/**
+		* start a new file without freeing memory
+		*/
+		void restart() {
+			bytes.clear();
+			assetIndices.clear();
+			assetIds.clear();
+			manifestIds.clear();
+			start();
+		}
+
+		void append(const void *data, size_t size) {
+			size_t offset = bytes.size();
+			bytes.resize(offset + size);
+			if (size != 0)
+				std::memcpy(&bytes[offset], data, size);
+		}
+
+		/**
+		* write index of an asset in table of file (0 for assets which are not in manifests)
+		*/
+		void writeAsset(const Core::AssetKey &key) {
+			if (manifestIds.empty())
+				for (const std::pair<const std::string, int> &id : Core::manifestIds) {
+					const Core::ManifestAsset &asset = Core::manifestAssets[id.second];
+					if (asset.loaded())
+						manifestIds[Core::assetKey(asset)] = id.first;
+				}
+			std::map<Core::AssetKey, Uint32>::const_iterator found = assetIndices.find(key);
+			if (found != assetIndices.end()) {
+				write(found->second);
+				return;
+			}
+			std::map<Core::AssetKey, std::string>::const_iterator id = manifestIds.find(key);
+			if ((key.first == nullptr && key.second < 0) || id == manifestIds.end()) {
+				write(Uint32(0));
+				return;
+			}
+			assetIds.push_back(id->second);
+			assetIndices[key] = Uint32(assetIds.size());
+			write(Uint32(assetIds.size()));
+		}
+	};
+
+	/**
+	* read a file which is written by BinaryWriter
+	* values must be read in the same order which they are written, reading past end of file returns
+	* zero values and makes ok() false
+	* @see BinaryWriter
+	*/
+	class BinaryReader {
+	public:
+		BinaryReader() = default;
+		BinaryReader(const BinaryReader &) = delete;
+		BinaryReader &operator=(const BinaryReader &) = delete;
+
+		/**
+		* read bytes in memory (for example bytes which are released by BinaryWriter)
+		* bytes must be alive while reader is used
+		*/
+		explicit BinaryReader(const std::vector<char> &bytes) {
+			failed = !begin(bytes.data(), bytes.size());
+		}
+
+		~BinaryReader() {
+			close();
+		}
+
+		/**
+		* open a file, it is mapped to memory on linux, so arrays are used without copy
+		* @param path path of file
+		* @return false if file is missing or is not a valid save file
+		*/
+		bool open(const std::string &path) {
+			close();
+#if defined(__linux__)
+			int file = ::open(path.c_str(), O_RDONLY);
+			struct stat info;
+			if (file >= 0 && fstat(file, &info) == 0 && info.st_size > 0) {
+				void *map = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+				if (map != MAP_FAILED) {
+					mapped = map;
+					mappedSize = size_t(info.st_size);
+				}
+			}
+			if (file >= 0)
+				::close(file);
+			failed = mapped == nullptr || !begin((const char *)mapped, mappedSize);
+#else
+			std::ifstream file(path, std::ios::binary);
+			copy.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+			failed = !file || !begin(copy.data(), copy.size());
+#endif
+			return !failed;
+		}
+
+		/**
+		* version of game data which is given to BinaryWriter
+		*/
+		Uint32 getVersion() const {
+			return header.version;
+		}
+
+		/**
+		* check whether file is valid and all values are read inside the file
+		*/
+		bool ok() const {
+			return !failed;
+		}
+
+		/**
+		* read a value which is written by BinaryWriter::write
+		*/
+		template <typename T>
+		T read() {
+			static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable types can be read");
+			T value;
+			const char *source = take(sizeof(T));
+			if (source != nullptr)
+				std::memcpy(&value, source, sizeof(T));
+			else
+				std::memset(&value, 0, sizeof(T));
+			return value;
+		}
+
+		/**
+		* read a string
+		*/
+		std::string readString() {
+			Uint32 size = read<Uint32>();
+			const char *source = take(size);
+			return source != nullptr ? std::string(source, size) : std::string();
+		}
+
+		/**
+		* read an array without copy, the pointer is valid until reader is closed
+		* @param count number of items
+		* @return first item (nullptr if array is empty or file is not valid)
+		*/
+		template <typename T>
+		const T *readArray(size_t &count) {
+			static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable types can be read");
+			Uint64 size = read<Uint64>();
+			position = std::min(end, (position + Core::saveAlignment - 1) / Core::saveAlignment * Core::saveAlignment);
+			count = 0;
+			if (size > (end - position) / sizeof(T)) {
+				failed = true;
+				return nullptr;
+			}
+			const T *items = (const T *)take(size_t(size) * sizeof(T));
+			count = items != nullptr ? size_t(size) : 0;
+			return count != 0 ? items : nullptr;
+		}
+
+		/**
+		* read an array to a vector
+		*/
+		template <typename T>
+		void readArray(std::vector<T> &items) {
+			size_t count;
+			const T *first = readArray<T>(count);
+			items.assign(first, first + count);
+		}
+
+		/**
+		* read a texture by its id, its group must be loaded
+		*/
+		Texture readTexture() {
+			const std::string *id = readAsset();
+			return id != nullptr ? getTexture(*id) : Texture();
+		}
+
+		/**
+		* read a sound or music by its id, its group must be loaded
+		*/
+		Sound *readSound() {
+			const std::string *id = readAsset();
+			return id != nullptr ? getSound(*id) : nullptr;
+		}
+
+		Music *readMusic() {
+			const std::string *id = readAsset();
+			return id != nullptr ? getMusic(*id) : nullptr;
+		}
+
+		/**
+		* stop reading and unmap file
+		*/
+		void close() {
+#if defined(__linux__)
+			if (mapped != nullptr)
+				munmap(mapped, mappedSize);
+#endif
+			mapped = nullptr;
+			mappedSize = 0;
+			copy.clear();
+			assetIds.clear();
+			data = nullptr;
+			position = end = 0;
+			failed = true;
+		}
+
+	private:
+		Core::SaveHeader header = {};
+		const char *data = nullptr;
+		size_t position = 0, end = 0;
+		bool failed = true;
+
+		/**
+		* mapped file or copy of file where memory map is not used
+		*/
+		void *mapped = nullptr;
+		size_t mappedSize = 0;
+		std::vector<char> copy;
+
+		/**
+		* ids of assets which are written to file
+		*/
+		std::vector<std::string> assetIds;
+
+		/**
+		* check header and read table of asset ids
+		*/
+		bool begin(const char *bytes, size_t size) {
+			if (size < sizeof(Core::SaveHeader))
+				return false;
+			std::memcpy(&header, bytes, sizeof(header));
+			if (std::memcmp(header.magic, "SBSV", 4) != 0 || header.formatVersion != Core::saveFormatVersion ||
+				header.byteOrder != Core::saveByteOrder || header.size != size || header.assetsOffset > size ||
+				header.assetsOffset < sizeof(header))
+				return false;
+
+			data = bytes;
+			failed = false;
+			position = size_t(header.assetsOffset);
+			end = size;
+			Uint32 count = read<Uint32>();
+			for (Uint32 i = 0; i < count && !failed; i++)
+				assetIds.push_back(readString());
+			position = sizeof(header);
+			end = size_t(header.assetsOffset);
+			return !failed;
+		}
+
+		/**
+		* get next bytes of file and move forward
+		* @return the bytes (nullptr if file ends before them)
+		*/
+		const char *take(size_t size) {
+			if (failed || size > end - position) {
+				failed = true;
+				return nullptr;
+			}
+			const char *result = data + position;
+			position += size;
+			return result;
+		}
+
+		const std::string *readAsset() {
+			Uint32 index = read<Uint32>();
+			if (index == 0 || index > assetIds.size())
+				return nullptr;
+			return &assetIds[index - 1];
+		}
+	};
+
+	/**
+	* wait until all saves of BinaryWriter::saveAsync are written
+	* @return false if a save is failed since last call
+	*/
+	bool waitForSaves() {
+		while (Core::pendingSaves.load() > 0)
+			SDL_Delay(1);
+		return Core::failedSaves.exchange(0) == 0;
+	}
+
+	/**
+	* keep snapshots of game state of last frames for rollback and replay
+	* state is registered as memory regions, each capture copies them and keeps only the XOR difference
+	* with the previous capture (run length encoded), so unchanged state costs almost nothing
+	*/
+	class SnapshotRing {
+	public:
+		/**
+		* @param frames number of last frames which can be restored
+		*/
+		explicit SnapshotRing(int frames = 60) : slots(std::max(1, frames)) {
+		}
+
+		/**
+		* register a memory region of game state, its address and size must not change
+		* snapshots which are captured before are removed
+		* @param data first byte of region
+		* @param size size of region in bytes
+		*/
+		void add(void *data, size_t size) {
+			Region region;
+			region.data = (Uint8 *)data;
+			region.size = size;
+			region.offset = words;
+			regions.push_back(region);
+			words += (size + sizeof(Uint64) - 1) / sizeof(Uint64);
+
+			// buffers are allocated here, captures don't allocate memory unless a difference is very large
+			latest.assign(words, 0);
+			scratch.assign(words, 0);
+			for (Slot &slot : slots) {
+				slot.delta.clear();
+				slot.delta.reserve(words / 4 + 16);
+			}
+			clear();
+		}
+
+		/**
+		* register a value of game state (a trivially copyable object or array)
+		*/
+		template <typename T>
+		void add(T &value) {
+			static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable state can be captured");
+			add(&value, sizeof(T));
+		}
+
+		/**
+		* capture registered state of a frame, the oldest snapshot is removed if ring is full
+		* @param frame number of frame
+		*/
+		void capture(Uint32 frame) {
+			gather();
+			if (count > 0) {
+				Slot &previous = slots[(first + count - 1) % slots.size()];
+				encode(latest.data(), scratch.data(), previous.delta);
+				if (count == int(slots.size())) {
+					first = (first + 1) % slots.size();
+					count--;
+				}
+			}
+			Slot &slot = slots[(first + count) % slots.size()];
+			slot.frame = frame;
+			slot.delta.clear();
+			count++;
+			latest.swap(scratch);
+		}
+
+		/**
+		* restore registered state of a frame
+		* @param frame number of frame
+		* @param dropNewer remove snapshots after the frame (for rollback, because game is simulated again from it)
+		* @return false if frame is not in ring
+		*/
+		bool restore(Uint32 frame, bool dropNewer = true) {
+			int index = find(frame);
+			if (index < 0)
+				return false;
+			// walk back from the latest snapshot, each difference turns a snapshot into the one before it
+			std::copy(latest.begin(), latest.end(), scratch.begin());
+			for (int i = count - 2; i >= index; i--)
+				decode(scratch.data(), slots[(first + i) % slots.size()].delta);
+			for (const Region &region : regions)
+				std::memcpy(region.data, scratch.data() + region.offset, region.size);
+			if (dropNewer) {
+				count = index + 1;
+				slots[(first + index) % slots.size()].delta.clear();
+				latest.swap(scratch);
+			}
+			return true;
+		}
+
+		/**
+		* check whether a frame can be restored
+		*/
+		bool contains(Uint32 frame) const {
+			return find(frame) >= 0;
+		}
+
+		/**
+		* number of frames which can be restored
+		*/
+		int size() const {
+			return count;
+		}
+
+		/**
+		* remove all snapshots (registered regions are kept)
+		*/
+		void clear() {
+			first = count = 0;
+		}
+
+		/**
+		* size of differences which are stored, full size of state is stored once more for the latest frame
+		* @return size in bytes
+		*/
+		size_t getDeltaBytes() const {
+			size_t bytes = 0;
+			for (int i = 0; i < count; i++)
+				bytes += slots[(first + i) % slots.size()].delta.size() * sizeof(Uint64);
+			return bytes;
+		}
+
+	private:
+		/**
+		* a registered memory region and its position in snapshots (in words)
+		*/
+		struct Region {
+			Uint8 *data;
+			size_t size;
+			size_t offset;
+		};
+
+		/**
+		* a snapshot and difference between it and the next snapshot
+		* difference is a list of tokens: (number of equal words << 32 | number of changed words) and
+		* XOR of changed words
+		*/
+		struct Slot {
+			Uint32 frame = 0;
+			std::vector<Uint64> delta;
+		};
+
+		std::vector<Region> regions;
+		size_t words = 0;
+		std::vector<Slot> slots;
+		int first = 0, count = 0;
+
+		/**
+		* state of the latest snapshot and a buffer of same size
+		*/
+		std::vector<Uint64> latest, scratch;
+
+		/**
+		* copy registered regions to scratch
+		*/
+		void gather() {
+			for (const Region &region : regions)
+				std::memcpy(scratch.data() + region.offset, region.data, region.size);
+		}
+
+		int find(Uint32 frame) const {
+			for (int i = count - 1; i >= 0; i--)
+				if (slots[(first + i) % slots.size()].frame == frame)
+					return i;
+			return -1;
+		}
+
+		/**
+		* encode XOR of two states with run length of equal words
+		*/
+		void encode(const Uint64 *before, const Uint64 *after, std::vector<Uint64> &delta) const {
+			delta.clear();
+			size_t i = 0;
+			while (i < words) {
+				size_t equal = i;
+				while (equal < words && before[equal] == after[equal])
+					equal++;
+				if (equal == words)
+					break;
+				size_t changed = equal;
+				while (changed < words && before[changed] != after[changed])
+					changed++;
+				delta.push_back(Uint64(equal - i) << 32 | Uint64(changed - equal));
+				for (size_t j = equal; j < changed; j++)
+					delta.push_back(before[j] ^ after[j]);
+				i = changed;
+			}
+		}
+
+		/**
+		* apply a difference to a state
+		*/
+		static void decode(Uint64 *state, const std::vector<Uint64> &delta) {
+			size_t position = 0;
+			for (size_t i = 0; i < delta.size();) {
+				position += size_t(delta[i] >> 32);
+				size_t changed = size_t(delta[i] & 0xFFFFFFFF);
+				i++;
+				for (size_t j = 0; j < changed; j++)
+					state[position++] ^= delta[i++];
+			}
+		}
+	};
+
+	/**
+	* visibility polygon of a point against rectangles of level (for line of sight and shadows)
+	* occluders are kept in a grid of cells, so only occluders near the point are checked
+	* the polygon is made again only when the point, its radius or occluders are changed
+	*/
+	class Visibility {
+	public:
+		/**
+		* @param cellSize size of cells of grid of occluders
+		*/
+		explicit Visibility(int cellSize = 64) : cellSize(std::max(1, cellSize)) {
+		}
+
+		/**
+		* add a rectangle which blocks the view
+		*/
+		void addOccluder(const SDL_Rect &rect) {
+			if (rect.w > 0 && rect.h > 0) {
+				occluders.push_back(rect);
+				changed = true;
+			}
+		}
+
+		/**
+		* replace all occluders
+		*/
+		void setOccluders(const std::vector<SDL_Rect> &rects) {
+			occluders.clear();
+			for (const SDL_Rect &rect : rects)
+				addOccluder(rect);
+			changed = true;
+		}
+
+		/**
+		* remove all occluders
+		*/
+		void clearOccluders() {
+			occluders.clear();
+			changed = true;
+		}
+
+		/**
+		* compute the area which is visible from a point
+		* @param x x of point
+		* @param y y of point
+		* @param radius half size of square around point which limits the view
+		* @return corners of polygon in counterclockwise order around the point (empty if point is in an occluder)
+		*/
+		const std::vector<SDL_FPoint> &compute(float x, float y, float radius) {
+			if (!changed && x == centerX && y == centerY && radius == range)
+				return polygon;
+			if (changed)
+				buildGrid();
+			changed = false;
+			centerX = x;
+			centerY = y;
+			range = radius;
+			polygon.clear();
+			if (radius <= 0 || !gatherSegments())
+				return polygon;
+			sweep();
+			return polygon;
+		}
+
+		/**
+		* get the last computed polygon
+		*/
+		const std::vector<SDL_FPoint> &getPolygon() const {
+			return polygon;
+		}
+
+		/**
+		* draw the last computed polygon as a triangle fan in one batched draw
+		* @param r red of polygon
+		* @param g green of polygon
+		* @param b blue of polygon
+		* @param a alpha of polygon
+		*/
+		void draw(Uint8 r, Uint8 g, Uint8 b, Uint8 a = 255) const {
+			if (polygon.size() < 2)
+				return;
+			Core::batchGeometry(nullptr);
+			SDL_Color color = { r, g, b, a };
+			int first = int(Core::geometryVertices.size());
+			Core::geometryVertices.push_back({ { centerX, centerY }, color, { 0, 0 } });
+			for (const SDL_FPoint &point : polygon)
+				Core::geometryVertices.push_back({ point, color, { 0, 0 } });
+			pushFan(Core::geometryIndices, first);
+		}
+
+		/**
+		* add a light at the point to this frame which doesn't pass occluders (see enableLighting)
+		* its radius is the radius of the last computed polygon
+		* @param r red of light
+		* @param g green of light
+		* @param b blue of light
+		* @param intensity brightness of light (0 to 1)
+		*/
+		void addLight(Uint8 r = 255, Uint8 g = 255, Uint8 b = 255, float intensity = 1) const {
+			if (Core::lightMap == nullptr || polygon.size() < 2)
+				return;
+			intensity = std::max(0.0f, std::min(1.0f, intensity));
+			SDL_Color color = { Uint8(r * intensity + 0.5f), Uint8(g * intensity + 0.5f), Uint8(b * intensity + 0.5f), 255 };
+			// polygon is inside the square of radius, so it maps to the light texture like a quad of addLight
+			int first = int(Core::lightVertices.size());
+			Core::lightVertices.push_back({ { centerX, centerY }, color, { 0.5f, 0.5f } });
+			for (const SDL_FPoint &point : polygon)
+				Core::lightVertices.push_back({ point, color,
+					{ 0.5f + (point.x - centerX) / (2 * range), 0.5f + (point.y - centerY) / (2 * range) } });
+			pushFan(Core::lightIndices, first);
+		}
+
+	private:
+		/**
+		* an edge which blocks the view, relative to the point and from its smaller angle to its larger angle
+		*/
+		struct Segment {
+			float x1, y1, x2, y2;
+		};
+
+		/**
+		* start or end of a segment in the sweep
+		*/
+		struct Event {
+			float angle;
+			int segment;
+			bool begin;
+		};
+
+		int cellSize;
+		std::vector<SDL_Rect> occluders;
+		bool changed = true;
+
+		/**
+		* grid of occluders: first cell, size in cells, first occluder of each cell and occluders of cells
+		*/
+		int gridX = 0, gridY = 0, gridWidth = 0, gridHeight = 0;
+		std::vector<int> cellStarts, cellOccluders;
+
+		/**
+		* last occluder query which has seen each occluder, so occluders in many cells are used once
+		*/
+		std::vector<Uint32> seen;
+		Uint32 query = 0;
+
+		float centerX = 0, centerY = 0, range = -1;
+		std::vector<SDL_FPoint> polygon;
+		std::vector<Segment> segments;
+		std::vector<Event> events;
+		std::vector<int> active, activeIndex;
+
+		/**
+		* put occluders in cells of grid (counting sort, so cells are contiguous)
+		*/
+		void buildGrid() {
+			seen.assign(occluders.size(), query);
+			cellStarts.clear();
+			cellOccluders.clear();
+			gridWidth = gridHeight = 0;
+			if (occluders.empty())
+				return;
+			int left = occluders[0].x, top = occluders[0].y, right = left, bottom = top;
+			for (const SDL_Rect &rect : occluders) {
+				left = std::min(left, rect.x);
+				top = std::min(top, rect.y);
+				right = std::max(right, rect.x + rect.w);
+				bottom = std::max(bottom, rect.y + rect.h);
+			}
+			gridX = floorDivide(left, cellSize);
+			gridY = floorDivide(top, cellSize);
+			gridWidth = floorDivide(right - 1, cellSize) - gridX + 1;
+			gridHeight = floorDivide(bottom - 1, cellSize) - gridY + 1;
+
+			cellStarts.assign(size_t(gridWidth) * gridHeight + 1, 0);
+			for (int pass = 0; pass < 2; pass++) {
+				for (size_t i = 0; i < occluders.size(); i++) {
+					const SDL_Rect &rect = occluders[i];
+					for (int cy = floorDivide(rect.y, cellSize) - gridY; cy <= floorDivide(rect.y + rect.h - 1, cellSize) - gridY; cy++)
+						for (int cx = floorDivide(rect.x, cellSize) - gridX; cx <= floorDivide(rect.x + rect.w - 1, cellSize) - gridX; cx++) {
+							size_t cell = size_t(cy) * gridWidth + cx;
+							if (pass == 0)
+								cellStarts[cell + 1]++;
+							else
+								cellOccluders[cellStarts[cell]++] = int(i);
+						}
+				}
+				if (pass == 0) {
+					for (size_t cell = 1; cell < cellStarts.size(); cell++)
+						cellStarts[cell] += cellStarts[cell - 1];
+					cellOccluders.resize(cellStarts.back());
+				}
+				else
+					// second pass moved each start to end of its cell
+					for (size_t cell = cellStarts.size() - 1; cell > 0; cell--)
+						cellStarts[cell] = cellStarts[cell - 1];
+			}
+			cellStarts[0] = 0;
+		}
+
+		static int floorDivide(int value, int divisor) {
+			return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+		}
 
-		SDL_SetWindowTitle(Core::window, windowsTitle.c_str());
-		// inilialize SDL_mixer, exit if fail
-		if (SDL_Init(SDL_INIT_AUDIO) < 0) {
-			SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "SBDL initialization", "SBDL initialize audio engine error",
-				nullptr);
-			exit(1);
+		/**
+		* add an edge which faces the point, relative to the point
+		*/
+		void addSegment(float x1, float y1, float x2, float y2) {
+			x1 -= centerX;
+			y1 -= centerY;
+			x2 -= centerX;
+			y2 -= centerY;
+			if (x1 * y2 - y1 * x2 < 0) {
+				std::swap(x1, x2);
+				std::swap(y1, y2);
+			}
+			segments.push_back({ x1, y1, x2, y2 });
 		}
 
-		// setup audio mode
-		Mix_OpenAudio(22050, AUDIO_S16SYS, 2, 640);
-		// setup text system
-		TTF_Init();
-	}
+		/**
+		* make segments of the square of view and of edges of near occluders which face the point
+		* @return false if the point is in an occluder
+		*/
+		bool gatherSegments() {
+			const float left = centerX - range, top = centerY - range, right = centerX + range, bottom = centerY + range;
+			segments.clear();
+			addSegment(left, top, right, top);
+			addSegment(right, top, right, bottom);
+			addSegment(right, bottom, left, bottom);
+			addSegment(left, bottom, left, top);
+			if (gridWidth == 0)
+				return true;
+
+			if (++query == 0) {
+				std::fill(seen.begin(), seen.end(), 0);
+				query = 1;
+			}
+			int firstX = std::max(0, floorDivide(int(std::floor(left)), cellSize) - gridX);
+			int firstY = std::max(0, floorDivide(int(std::floor(top)), cellSize) - gridY);
+			int lastX = std::min(gridWidth - 1, floorDivide(int(std::ceil(right)), cellSize) - gridX);
+			int lastY = std::min(gridHeight - 1, floorDivide(int(std::ceil(bottom)), cellSize) - gridY);
+			for (int cy = firstY; cy <= lastY; cy++)
+				for (int cx = firstX; cx <= lastX; cx++) {
+					size_t cell = size_t(cy) * gridWidth + cx;
+					for (int i = cellStarts[cell]; i < cellStarts[cell + 1]; i++) {
+						int index = cellOccluders[i];
+						if (seen[index] == query)
+							continue;
+						seen[index] = query;
+
+						// occluders are clipped to the square, so no edge crosses the square between events
+						const SDL_Rect &rect = occluders[index];
+						float x1 = std::max(left, float(rect.x)), y1 = std::max(top, float(rect.y));
+						float x2 = std::min(right, float(rect.x + rect.w)), y2 = std::min(bottom, float(rect.y + rect.h));
+						if (x1 >= x2 || y1 >= y2)
+							continue;
+						if (centerX >= x1 && centerX <= x2 && centerY >= y1 && centerY <= y2)
+							return false;
+						// only edges which face the point can be nearest, edges in line with the point are skipped
+						if (centerY < y1)
+							addSegment(x1, y1, x2, y1);
+						if (centerY > y2)
+							addSegment(x1, y2, x2, y2);
+						if (centerX < x1)
+							addSegment(x1, y1, x1, y2);
+						if (centerX > x2)
+							addSegment(x2, y1, x2, y2);
+					}
+				}
+			return true;
+		}
+
+		/**
+		* distance of a segment along a ray from the point
+		*/
+		float distance(int index, float dx, float dy) const {
+			const Segment &s = segments[index];
+			float ex = s.x2 - s.x1, ey = s.y2 - s.y1;
+			float denominator = dx * ey - dy * ex;
+			if (std::fabs(denominator) < 1e-12f)
+				return std::min(std::sqrt(s.x1 * s.x1 + s.y1 * s.y1), std::sqrt(s.x2 * s.x2 + s.y2 * s.y2));
+			return (s.x1 * ey - s.y1 * ex) / denominator;
+		}
+
+		/**
+		* nearest active segment along a ray
+		* @param segment index of nearest segment
+		* @return distance of nearest segment
+		*/
+		float nearest(float dx, float dy, int &segment) const {
+			float result = 2 * std::sqrt(2.0f) * range;
+			segment = -1;
+			for (int index : active) {
+				float d = distance(index, dx, dy);
+				if (d < result) {
+					result = d;
+					segment = index;
+				}
+			}
+			return result;
+		}
+
+		/**
+		* add the point where two segments cross, the nearest segment changes there between two events
+		* (only edges of occluders which overlap cross each other)
+		*/
+		void addCrossing(int first, int second) {
+			const Segment &a = segments[first], &b = segments[second];
+			float ax = a.x2 - a.x1, ay = a.y2 - a.y1, bx = b.x2 - b.x1, by = b.y2 - b.y1;
+			float denominator = ax * by - ay * bx;
+			if (std::fabs(denominator) < 1e-12f)
+				return;
+			float t = ((b.x1 - a.x1) * by - (b.y1 - a.y1) * bx) / denominator;
+			if (t > 0 && t < 1)
+				polygon.push_back({ centerX + a.x1 + ax * t, centerY + a.y1 + ay * t });
+		}
+
+		void activate(int index) {
+			activeIndex[index] = int(active.size());
+			active.push_back(index);
+		}
+
+		void deactivate(int index) {
+			int position = activeIndex[index];
+			if (position < 0)
+				return;
+			active[position] = active.back();
+			activeIndex[active.back()] = position;
+			active.pop_back();
+			activeIndex[index] = -1;
+		}
+
+		/**
+		* sweep a ray around the point over sorted angles of ends of segments, keeping segments which the ray crosses
+		* at each angle the nearest segment before and after the events is a corner of polygon
+		*/
+		void sweep() {
+			events.clear();
+			active.clear();
+			activeIndex.assign(segments.size(), -1);
+			for (size_t i = 0; i < segments.size(); i++) {
+				const Segment &s = segments[i];
+				float begin = std::atan2(s.y1, s.x1), end = std::atan2(s.y2, s.x2);
+				events.push_back({ begin, int(i), true });
+				events.push_back({ end, int(i), false });
+				// segments which cross the angle of pi are crossed by the ray at start
+				if (end < begin)
+					activate(int(i));
+			}
+			std::sort(events.begin(), events.end(), [](const Event &a, const Event &b) { return a.angle < b.angle; });
+
+			int previous = -1, current, first = -1;
+			for (size_t i = 0; i < events.size();) {
+				const float angle = events[i].angle, dx = std::cos(angle), dy = std::sin(angle);
+				float before = nearest(dx, dy, current);
+				if (previous >= 0 && current >= 0 && current != previous)
+					addCrossing(previous, current);
+				if (i == 0)
+					first = current;
+				size_t j = i;
+				for (; j < events.size() && events[j].angle == angle; j++)
+					if (events[j].begin)
+						activate(events[j].segment);
+					else
+						deactivate(events[j].segment);
+				i = j;
+				float after = nearest(dx, dy, previous);
+				polygon.push_back({ centerX + dx * before, centerY + dy * before });
+				if (std::fabs(after - before) > 1e-3f * range)
+					polygon.push_back({ centerX + dx * after, centerY + dy * after });
+			}
+			// the last corner is joined to the first one
+			if (previous >= 0 && first >= 0 && previous != first)
+				addCrossing(previous, first);
+		}
+
+		/**
+		* add triangles of a fan around vertex first to indices
+		*/
+		void pushFan(std::vector<int> &indices, int first) const {
+			int count = int(polygon.size());
+			for (int i = 0; i < count; i++) {
+				indices.push_back(first);
+				indices.push_back(first + 1 + i);
+				indices.push_back(first + 1 + (i + 1) % count);
+			}
+		}
+	};
 
 	/**
-	* update state of keyboard buttons (release or push) and mouse
-	* call this function in a loop after initialize engine for get updated state all times
+	* grid of walkable and blocked cells for pathfinding, agents move to 8 neighbours but not through corners
 	*/
-	void updateEvents() {
-		// update keyboard state
-		if (Core::keystate_size == -1) {
-			Core::keystate = SDL_GetKeyboardState(&Core::keystate_size);
-			Core::old_keystate = new Uint8[Core::keystate_size];
-			for (int i = 0; i < Core::keystate_size; i++)
-				Core::old_keystate[i] = 0;
+	class PathGrid {
+	public:
+		/**
+		* @param width number of columns
+		* @param height number of rows
+		*/
+		PathGrid(int width, int height) : width(std::max(1, width)), height(std::max(1, height)),
+			cells(size_t(this->width) * this->height, 0) {
 		}
-		else {
-			for (int i = 0; i < Core::keystate_size; i++)
-				Core::old_keystate[i] = Core::keystate[i];
-			Core::keystate = SDL_GetKeyboardState(&Core::keystate_size);
+
+		int getWidth() const {
+			return width;
 		}
-		SDL_PumpEvents();
 
-		// reset event handler state for check it again
-		Core::event = {};
+		int getHeight() const {
+			return height;
+		}
 
-		// returns true if there is an event in the queue, but will not remove it
-		if (!SDL_PollEvent(nullptr)) {
-			Mouse.left = Mouse.middle = Mouse.right = false;
-			Mouse.button = 0;
-			return;
+		/**
+		* number which changes when any cell is changed
+		*/
+		Uint32 getVersion() const {
+			return version;
 		}
-		while (SDL_PollEvent(&Core::event)) { // loop until there is a new event for handling
-			if (Core::event.type == SDL_MOUSEBUTTONDOWN || Core::event.type == SDL_MOUSEBUTTONUP) {
-				// update state of Mouse structure if it was changed
-				switch (Core::event.button.button) {
-				case 1:
-					Mouse.left = true;
-					Mouse.right = Mouse.middle = false;
-					break;
-				case 2:
-					Mouse.middle = true;
-					Mouse.right = Mouse.left = false;
-					break;
-				case 3:
-					Mouse.right = true;
-					Mouse.left = Mouse.middle = false;
-					break;
-				default:
-					Mouse.left = Mouse.middle = Mouse.right = false;
+
+		/**
+		* block or open a cell
+		*/
+		void setBlocked(int x, int y, bool blocked = true) {
+			if (x >= 0 && y >= 0 && x < width && y < height) {
+				cells[size_t(y) * width + x] = blocked ? 1 : 0;
+				version++;
+			}
+		}
+
+		/**
+		* block or open cells which are covered by a rectangle of game coordinates (like blocks of a level)
+		* @param rect the rectangle
+		* @param cellSize size of each cell in game coordinates
+		*/
+		void blockRect(const SDL_Rect &rect, int cellSize, bool blocked = true) {
+			int left = std::max(0, rect.x / cellSize), top = std::max(0, rect.y / cellSize);
+			int right = std::min(width - 1, (rect.x + rect.w - 1) / cellSize);
+			int bottom = std::min(height - 1, (rect.y + rect.h - 1) / cellSize);
+			for (int y = top; y <= bottom; y++)
+				for (int x = left; x <= right; x++)
+					cells[size_t(y) * width + x] = blocked ? 1 : 0;
+			version++;
+		}
+
+		/**
+		* open all cells
+		*/
+		void clear() {
+			std::fill(cells.begin(), cells.end(), 0);
+			version++;
+		}
+
+		bool isWalkable(int x, int y) const {
+			return x >= 0 && y >= 0 && x < width && y < height && cells[size_t(y) * width + x] == 0;
+		}
+
+		/**
+		* find a shortest path with A*
+		* @param startX x of start cell
+		* @param startY y of start cell
+		* @param goalX x of goal cell
+		* @param goalY y of goal cell
+		* @param path cells of path from start to goal
+		* @return false if there is no path
+		*/
+		bool findPath(int startX, int startY, int goalX, int goalY, std::vector<SDL_Point> &path) {
+			return search(startX, startY, goalX, goalY, path, false);
+		}
+
+		/**
+		* find a shortest path with jump point search, it is A* which skips straight runs of open cells
+		* and is much faster on large open areas
+		* @see findPath
+		*/
+		bool findJumpPath(int startX, int startY, int goalX, int goalY, std::vector<SDL_Point> &path) {
+			return search(startX, startY, goalX, goalY, path, true);
+		}
+
+		/**
+		* number of cells which are expanded by the last search
+		*/
+		int getExpandedCells() const {
+			return expanded;
+		}
+
+	private:
+		friend class FlowField;
+
+		int width, height;
+		std::vector<Uint8> cells;
+		Uint32 version = 0;
+
+		/**
+		* state of searches, it is allocated once and is valid only if stamp of cell is the generation of search
+		*/
+		std::vector<int> costs, parents;
+		std::vector<Uint32> stamps;
+		Uint32 generation = 0;
+
+		/**
+		* a cell in open list (binary heap), with estimated cost of path through it and cost to reach it
+		*/
+		struct OpenCell {
+			int estimate, cost, cell;
+
+			/**
+			* order of heap, among equal estimates cells nearer to goal are expanded first
+			*/
+			bool operator<(const OpenCell &other) const {
+				return estimate > other.estimate || (estimate == other.estimate && cost < other.cost);
+			}
+		};
+		std::vector<OpenCell> open;
+		int expanded = 0, goalCell = 0;
+
+		/**
+		* directions to neighbours, straight directions first
+		*/
+		static const int directions[8][2];
+
+		/**
+		* check whether an agent can move from a cell to a neighbour (diagonal moves need both sides open)
+		*/
+		static bool canMove(const Uint8 *cells, int width, int height, int x, int y, int dx, int dy) {
+			auto walkable = [&](int cx, int cy) {
+				return cx >= 0 && cy >= 0 && cx < width && cy < height && cells[size_t(cy) * width + cx] == 0;
+			};
+			return walkable(x + dx, y + dy) && (dx == 0 || dy == 0 || (walkable(x + dx, y) && walkable(x, y + dy)));
+		}
+
+		/**
+		* costs of a straight and a diagonal move, costs are integers so equal costs compare equal
+		*/
+		static const int straightCost = 1000, diagonalCost = 1414;
+
+		/**
+		* octile distance, the exact cost between two cells without blocked cells
+		*/
+		static int octile(int dx, int dy) {
+			dx = std::abs(dx);
+			dy = std::abs(dy);
+			return std::max(dx, dy) * straightCost + std::min(dx, dy) * (diagonalCost - straightCost);
+		}
+
+		bool canMove(int x, int y, int dx, int dy) const {
+			return canMove(cells.data(), width, height, x, y, dx, dy);
+		}
+
+		/**
+		* find next jump point from a cell in a direction, or -1
+		*/
+		int jump(int x, int y, int dx, int dy) const {
+			for (;;) {
+				if (!canMove(x, y, dx, dy))
+					return -1;
+				x += dx;
+				y += dy;
+				int cell = y * width + x;
+				if (cell == goalCell)
+					return cell;
+				if (dx != 0 && dy != 0) {
+					// a diagonal move stops where a straight move finds a jump point
+					if (jump(x, y, dx, 0) >= 0 || jump(x, y, 0, dy) >= 0)
+						return cell;
+				}
+				else if (dx != 0) {
+					// a forced neighbour: open cell beside which was blocked behind
+					if ((isWalkable(x, y - 1) && !isWalkable(x - dx, y - 1)) || (isWalkable(x, y + 1) && !isWalkable(x - dx, y + 1)))
+						return cell;
 				}
+				else if ((isWalkable(x - 1, y) && !isWalkable(x - 1, y - dy)) || (isWalkable(x + 1, y) && !isWalkable(x + 1, y - dy)))
+					return cell;
+			}
+		}
 
-				Mouse.state = Core::event.button.state;
-				Mouse.button = Core::event.button.button;
-				Mouse.clicks = Core::event.button.clicks;
+		/**
+		* directions which jump point search follows from a cell, given the cell it is reached from
+		* @return number of directions
+		*/
+		int prunedDirections(int x, int y, int parent, int moves[8][2]) const {
+			const int px = (x > parent % width) - (x < parent % width), py = (y > parent / width) - (y < parent / width);
+			int count = 0;
+			auto add = [&](int dx, int dy) {
+				moves[count][0] = dx;
+				moves[count++][1] = dy;
+			};
+			if (px != 0 && py != 0) {
+				bool vertical = isWalkable(x, y + py), horizontal = isWalkable(x + px, y);
+				if (vertical)
+					add(0, py);
+				if (horizontal)
+					add(px, 0);
+				if (vertical && horizontal)
+					add(px, py);
 			}
-			// update position of mouse if it was changed
-			if (Core::event.type == SDL_MOUSEMOTION) {
-				Mouse.x = Core::event.motion.x;
-				Mouse.y = Core::event.motion.y;
+			else if (px != 0) {
+				bool up = isWalkable(x, y - 1), down = isWalkable(x, y + 1);
+				if (isWalkable(x + px, y)) {
+					add(px, 0);
+					if (up)
+						add(px, -1);
+					if (down)
+						add(px, 1);
+				}
+				if (up)
+					add(0, -1);
+				if (down)
+					add(0, 1);
 			}
-			if (Core::event.type == SDL_QUIT) {
-				Core::running = false;
+			else {
+				bool left = isWalkable(x - 1, y), right = isWalkable(x + 1, y);
+				if (isWalkable(x, y + py)) {
+					add(0, py);
+					if (left)
+						add(-1, py);
+					if (right)
+						add(1, py);
+				}
+				if (left)
+					add(-1, 0);
+				if (right)
+					add(1, 0);
 			}
+			return count;
 		}
-	}
+
+		/**
+		* add a cell to open list if it is reached with a lower cost
+		*/
+		void reach(int x, int y, int parent, int cost, int goalX, int goalY) {
+			const int cell = y * width + x;
+			if (stamps[cell] == generation && costs[cell] <= cost)
+				return;
+			stamps[cell] = generation;
+			costs[cell] = cost;
+			parents[cell] = parent;
+			open.push_back({ cost + octile(goalX - x, goalY - y), cost, cell });
+			std::push_heap(open.begin(), open.end());
+		}
+
+		bool search(int startX, int startY, int goalX, int goalY, std::vector<SDL_Point> &path, bool jumpPoints) {
+			path.clear();
+			expanded = 0;
+			if (!isWalkable(startX, startY) || !isWalkable(goalX, goalY))
+				return false;
+			const size_t size = cells.size();
+			if (stamps.size() != size) {
+				costs.assign(size, 0);
+				parents.assign(size, -1);
+				stamps.assign(size, 0);
+				open.reserve(size / 8 + 16);
+			}
+			if (++generation == 0) {
+				std::fill(stamps.begin(), stamps.end(), 0);
+				generation = 1;
+			}
+			open.clear();
+			goalCell = goalY * width + goalX;
+			reach(startX, startY, -1, 0, goalX, goalY);
+
+			while (!open.empty()) {
+				std::pop_heap(open.begin(), open.end());
+				const OpenCell top = open.back();
+				open.pop_back();
+				const int cell = top.cell, x = cell % width, y = cell / width;
+				// entries of cells which are reached again with a lower cost are skipped
+				if (top.cost > costs[cell])
+					continue;
+				if (cell == goalCell) {
+					buildPath(cell, path);
+					return true;
+				}
+				expanded++;
+
+				if (!jumpPoints) {
+					for (const int *direction : directions)
+						if (canMove(x, y, direction[0], direction[1]))
+							reach(x + direction[0], y + direction[1], cell, costs[cell] + octile(direction[0], direction[1]), goalX, goalY);
+					continue;
+				}
+
+				// jump point search only follows directions which can't be reached better without this cell
+				int moves[8][2], count = 0;
+				if (parents[cell] < 0)
+					for (const int *direction : directions) {
+						moves[count][0] = direction[0];
+						moves[count++][1] = direction[1];
+					}
+				else
+					count = prunedDirections(x, y, parents[cell], moves);
+				for (int i = 0; i < count; i++) {
+					int next = jump(x, y, moves[i][0], moves[i][1]);
+					if (next >= 0) {
+						const int nextX = next % width, nextY = next / width;
+						reach(nextX, nextY, cell, costs[cell] + octile(nextX - x, nextY - y), goalX, goalY);
+					}
+				}
+			}
+			return false;
+		}
+
+		/**
+		* make cells of path from parents of goal, straight and diagonal runs between jump points are filled
+		*/
+		void buildPath(int cell, std::vector<SDL_Point> &path) {
+			for (; cell >= 0; cell = parents[cell]) {
+				int x = cell % width, y = cell / width, parent = parents[cell];
+				path.push_back({ x, y });
+				if (parent < 0)
+					break;
+				int dx = (parent % width > x) - (parent % width < x), dy = (parent / width > y) - (parent / width < y);
+				for (x += dx, y += dy; y * width + x != parent; x += dx, y += dy)
+					path.push_back({ x, y });
+			}
+			std::reverse(path.begin(), path.end());
+		}
+	};
+
+	const int PathGrid::directions[8][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 }, { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 } };
 
 	/**
-	* get Milliseconds since program was started.
+	* distances of all cells of a PathGrid to one goal, many agents which share the goal read their direction from it
+	* it can be computed in slices over many frames, or on a worker thread; agents use the previous field until
+	* the new one is ready
 	*/
-	unsigned int getTime() {
-		return SDL_GetTicks();
-	}
+	class FlowField {
+	public:
+		/**
+		* @param grid the grid, it must live as long as the field
+		*/
+		explicit FlowField(const PathGrid &grid) : grid(grid) {
+		}
+
+		~FlowField() {
+			stopWorker();
+		}
+
+		FlowField(const FlowField &) = delete;
+		FlowField &operator=(const FlowField &) = delete;
+
+		/**
+		* start computing the field of a goal, call update to continue it
+		* @param x x of goal cell
+		* @param y y of goal cell
+		*/
+		void setGoal(int x, int y) {
+			stopWorker();
+			start(x, y);
+		}
+
+		/**
+		* compute the field of a goal on a worker thread, call update to use it when it is ready
+		* the grid is copied, so it can be changed while the field is computed
+		* @param x x of goal cell
+		* @param y y of goal cell
+		*/
+		void setGoalAsync(int x, int y) {
+			stopWorker();
+			start(x, y);
+			finished = false;
+			worker = std::thread([this]() {
+				expand(-1);
+				finished = true;
+			});
+		}
+
+		/**
+		* continue computing the field and use it when it is ready, call it once per frame
+		* if the grid is changed, the field of the goal is computed again
+		* @param budget maximum number of cells which are computed in this call (-1 for all)
+		* @return true if a new field is used in this call
+		*/
+		bool update(int budget = -1) {
+			if (worker.joinable()) {
+				if (!finished)
+					return false;
+				worker.join();
+			}
+			else {
+				if (computing && version != grid.getVersion())
+					start(goalX, goalY);
+				if (!computing || !expand(budget))
+					return false;
+			}
+			computing = false;
+			distances.swap(working);
+			fieldCells.swap(cells);
+			fieldGoalX = goalX;
+			fieldGoalY = goalY;
+			return true;
+		}
+
+		/**
+		* check whether a field is ready to use
+		*/
+		bool ready() const {
+			return !distances.empty();
+		}
+
+		/**
+		* get distance of a cell to goal of the field
+		* @return distance in cells, or -1 if goal can't be reached from cell
+		*/
+		float getDistance(int x, int y) const {
+			if (distances.empty() || x < 0 || y < 0 || x >= width || y >= height)
+				return -1;
+			int distance = distances[size_t(y) * width + x];
+			return distance == unreachable ? -1 : float(distance) / PathGrid::straightCost;
+		}
+
+		/**
+		* get direction to move from a cell on a shortest path to goal of the field
+		* @param x x of cell
+		* @param y y of cell
+		* @param dx x of direction (-1, 0 or 1)
+		* @param dy y of direction (-1, 0 or 1)
+		* @return false if cell is the goal or goal can't be reached from it
+		*/
+		bool getDirection(int x, int y, int &dx, int &dy) const {
+			dx = dy = 0;
+			if (getDistance(x, y) <= 0)
+				return false;
+			int best = distances[size_t(y) * width + x];
+			for (const int *direction : PathGrid::directions) {
+				if (!PathGrid::canMove(fieldCells.data(), width, height, x, y, direction[0], direction[1]))
+					continue;
+				int distance = distances[size_t(y + direction[1]) * width + x + direction[0]];
+				if (distance == unreachable)
+					continue;
+				// the first neighbour on a shortest path, straight moves are checked first
+				distance += PathGrid::octile(direction[0], direction[1]);
+				if (distance == best) {
+					dx = direction[0];
+					dy = direction[1];
+					break;
+				}
+			}
+			return dx != 0 || dy != 0;
+		}
+
+		/**
+		* get goal of the field which is used now
+		*/
+		void getGoal(int &x, int &y) const {
+			x = fieldGoalX;
+			y = fieldGoalY;
+		}
+
+	private:
+		const PathGrid &grid;
+		const int unreachable = 0x7FFFFFFF;
+
+		/**
+		* copy of cells of grid and size of grid when computing started, and cells of the field which is used
+		*/
+		std::vector<Uint8> cells, fieldCells;
+		int width = 0, height = 0;
+		Uint32 version = 0;
+
+		/**
+		* field which is used by agents, and field which is computed
+		*/
+		std::vector<int> distances, working;
+		std::vector<std::pair<int, int>> open;
+		int goalX = 0, goalY = 0, fieldGoalX = 0, fieldGoalY = 0;
+		bool computing = false;
+
+		std::thread worker;
+		std::atomic<bool> finished{ false }, cancelled{ false };
 
+		void stopWorker() {
+			if (worker.joinable()) {
+				cancelled = true;
+				worker.join();
+				cancelled = false;
+			}
+		}
+
+		/**
+		* copy the grid and start from the goal
+		*/
+		void start(int x, int y) {
+			cells = grid.cells;
+			version = grid.getVersion();
+			// the field in use keeps its size until the new one replaces it
+			if (width != grid.getWidth() || height != grid.getHeight())
+				distances.clear();
+			width = grid.getWidth();
+			height = grid.getHeight();
+			goalX = x;
+			goalY = y;
+			working.assign(cells.size(), unreachable);
+			open.clear();
+			open.reserve(size_t(width + height) * 4);
+			computing = true;
+			if (x >= 0 && y >= 0 && x < width && y < height && cells[size_t(y) * width + x] == 0) {
+				working[size_t(y) * width + x] = 0;
+				open.push_back({ 0, y * width + x });
+			}
+		}
+
+		/**
+		* expand cells with the lowest distance first (Dijkstra), the open list is kept between calls
+		* @param budget maximum number of cells (-1 for all)
+		* @return true if all cells are computed
+		*/
+		bool expand(int budget) {
+			std::greater<std::pair<int, int>> later;
+			for (int count = 0; !open.empty(); count++) {
+				if (budget >= 0 && count >= budget)
+					return false;
+				if ((count & 1023) == 0 && cancelled)
+					return false;
+				std::pop_heap(open.begin(), open.end(), later);
+				const int distance = open.back().first;
+				const int cell = open.back().second;
+				open.pop_back();
+				if (distance > working[cell])
+					continue;
+				const int x = cell % width, y = cell / width;
+				for (const int *direction : PathGrid::directions) {
+					if (!PathGrid::canMove(cells.data(), width, height, x, y, direction[0], direction[1]))
+						continue;
+					const int next = cell + direction[1] * width + direction[0];
+					const int nextDistance = distance + PathGrid::octile(direction[0], direction[1]);
+					if (nextDistance < working[next]) {
+						working[next] = nextDistance;
+						open.push_back({ nextDistance, next });
+						std::push_heap(open.begin(), open.end(), later);
+					}
+				}
+			}
+			return true;
+		}
+	};
+
+#ifdef SBDL_COROUTINES
 	/**
-	* clear the current rendering target
+	* a script which runs through many frames, it is a C++20 coroutine:
+	* SBDL::Task flash(Texture &texture) {
+	*     for (int i = 0; i < 3; i++) {
+	*         visible = !visible;
+	*         co_await SBDL::seconds(0.2);
+	*     }
+	* }
+	* start a task with startTask, or wait for it in another task with co_await
+	* tasks are resumed by updateEvents, their frames are allocated from a pool
 	*/
-	void clearRenderScreen() {
-		SDL_RenderClear(Core::renderer);
-	}
+	class Task {
+	public:
+		struct promise_type;
+		typedef std::coroutine_handle<promise_type> Handle;
+
+		/**
+		* resumes task which waits for this task when it finishes, or frees it if it is started by startTask
+		*/
+		struct FinalAwaiter {
+			bool await_ready() noexcept {
+				return false;
+			}
+
+			std::coroutine_handle<> await_suspend(Handle task) noexcept {
+				promise_type &promise = task.promise();
+				if (promise.continuation)
+					return promise.continuation;
+				if (promise.detached)
+					task.destroy();
+				return std::noop_coroutine();
+			}
+
+			void await_resume() noexcept {
+			}
+		};
+
+		struct promise_type {
+			std::coroutine_handle<> continuation;
+			bool detached = false;
+
+			Task get_return_object() {
+				return Task(Handle::from_promise(*this));
+			}
+
+			std::suspend_always initial_suspend() noexcept {
+				return {};
+			}
+
+			FinalAwaiter final_suspend() noexcept {
+				return {};
+			}
 
-	/**
-	* update the screen and apply all changes
-	*/
-	void updateRenderScreen() {
-		SDL_RenderPresent(Core::renderer);
-	}
+			void return_void() {
+			}
 
-	/**
-	* wait a few milliseconds before continue process of application
-	* @param frameRate set the dalay (milisecond)
-	*/
-	void delay(Uint32 frameRate) {
-		SDL_Delay(frameRate);
-	}
+			void unhandled_exception() {
+				std::terminate();
+			}
 
-	/**
-	* load the font from a file
-	* @param path path of the font file to load
-	* @param size size of font
-	* @return font which is loaded
-	*/
-	Font *loadFont(const std::string &path, int size) {
-		return TTF_OpenFont(path.c_str(), size);
-	}
+			static void *operator new(size_t size) {
+				return Core::allocateCoroutineFrame(size);
+			}
 
-	/**
-	* load the texture from a file on disk
-	* @param path path of the image file to load
-	* @param alpha transparency level
-	* @return texture which is loaded
-	*/
-	Texture loadTexture(const std::string &path, Uint8 alpha = 255) {
-		return Core::loadTextureUnderneath(path, false, 0, 0, 0, alpha);
-	}
+			static void operator delete(void *frame, size_t size) {
+				Core::freeCoroutineFrame(frame, size);
+			}
+		};
 
-	/**
-	* load the texture from a file on disk and replace transparency of image with specific color
-	* @param path path of the image file to load
-	* @param r red color
-	* @param g green color
-	* @param b blue color
-	* @param alpha transparency level
-	* @return texture which is loaded
-	*/
-	Texture loadTexture(const std::string &path, Uint8 r, Uint8 g, Uint8 b, Uint8 alpha = 255) {
-		return Core::loadTextureUnderneath(path, true, r, g, b, alpha);
-	}
+		/**
+		* waits for a task in another task
+		*/
+		struct Awaiter {
+			Handle task;
 
-	/**
-	* play sound
-	* multiple sound can play concurrently
-	* @param sound sound which is loaded before
-	* @param count frequency of sound (-1 to play all time)
-	* @see loadSound
-	*/
-	void playSound(Sound *sound, int count) {
-		if (count != 0)
-			Mix_PlayChannel(-1, sound, (count > 0) ? count - 1 : -1);
-	}
+			bool await_ready() {
+				return !task || task.done();
+			}
 
-	/**
-	* play music
-	* only one music file can play
-	* @param music music which is loaded before
-	* @param count frequency of msuic (-1 to play all time)
-	* @see loadMusic
-	*/
-	void playMusic(Music *music, int count) {
-		Mix_PlayMusic(music, count);
-	}
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<> waiter) {
+				task.promise().continuation = waiter;
+				return task;
+			}
 
-	/**
-	* load sound from a file in disk (use .wav)
-	* @param path path of the sound file to load
-	* @return sound which is loaded
-	*/
-	Sound *loadSound(const std::string &path) {
-		Sound *sound;
-		sound = Mix_LoadWAV(path.c_str());
-		if (!sound) {
-			const std::string message = "Unable to load: " + path;
-			SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "SBDL load sound error", message.c_str(), nullptr);
-			exit(1);
-		}
-		return sound;
-	}
+			void await_resume() {
+			}
+		};
 
-	/**
-	* load music from a file in disk (use .ogg or .wav)
-	* @param path path of the music file to load
-	* @return music which is loaded
-	*/
-	Music *loadMusic(const std::string &path) {
-		Music *music;
-		music = Mix_LoadMUS(path.c_str());
-		if (!music) {
-			const std::string message = "Unable to load: " + path;
-			SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "SBDL load music error", message.c_str(), nullptr);
-			exit(1);
+		Task(Task &&other) noexcept : handle(other.handle) {
+			other.handle = nullptr;
 		}
-		return music;
-	}
 
-	/**
-	* stop music
-	*/
-	void stopMusic() {
-		Mix_HaltMusic();
-	}
+		Task &operator=(Task &&other) noexcept {
+			std::swap(handle, other.handle);
+			return *this;
+		}
 
-	/**
-	* stop all sounds
-	*/
-	void stopAllSounds() {
-		Mix_HaltChannel(-1);
-	}
+		Task(const Task &) = delete;
+		Task &operator=(const Task &) = delete;
 
-	/**
-	* free memory which is used for load sound from file
-	* @param sound Sound which you want to destroy
-	*/
-	void freeSound(Sound *sound) {
-		Mix_FreeChunk(sound);
-	}
+		~Task() {
+			if (handle)
+				handle.destroy();
+		}
 
-	/**
-	* free memory which is used for load music from file
-	* @param music Music which you want to destroy
-	*/
-	void freeMusic(Music *music) {
-		Mix_FreeMusic(music);
-	}
+		/**
+		* check whether task is finished
+		*/
+		bool done() const {
+			return !handle || handle.done();
+		}
 
-	/**
-	* free memory which is used for texture
-	* After call this function, texture is not usable anymore and any using has undefined behavior
-	* @param texture Texture which you want to destroy
-	*/
-	void freeTexture(Texture &texture) {
-		SDL_DestroyTexture(texture.underneathTexture);
-		texture.underneathTexture = nullptr;
-		texture.width = 0;
-		texture.height = 0;
-	}
+		Awaiter operator co_await() && {
+			return Awaiter { handle };
+		}
 
-	/**
-	* texture showed in render screen in position destRect with angle and flip
-	* @param texture the source texture
-	* @param angle an angle in degrees that indicates the rotation that will be applied to texture, rotating it in a clockwise direction around center of texture
-	* @param destRect custom rect to draw texture
-	* @param flip flipping actions performed on the texture (SDL_FLIP_NONE or SDL_FLIP_HORIZONTAL or SDL_FLIP_VERTICAL)
-	*/
-	void showTexture(const Texture &texture, double angle, const SDL_Rect &destRect,
-		SDL_RendererFlip flip = SDL_FLIP_NONE) {
-		SDL_RenderCopyEx(Core::renderer, texture.underneathTexture, nullptr, &destRect, angle, nullptr,
-			flip);
-	}
+		/**
+		* give the coroutine to caller, task doesn't free it anymore
+		*/
+		Handle release() {
+			Handle released = handle;
+			handle = nullptr;
+			return released;
+		}
 
-	/**
-	* texture showed in render screen in position texture.rect with angle and flip
-	* @param texture the source texture
-	* @param x position x
-	* @param y position y
-	* @param angle an angle in degrees that indicates the rotation that will be applied to texture, rotating it
-	in a clockwise direction around center of texture
-	* @param flip flipping actions performed on the texture (SDL_FLIP_NONE or SDL_FLIP_HORIZONTAL or SDL_FLIP_VERTICAL)
-	*/
-	void showTexture(const Texture &texture, int x, int y, double angle, SDL_RendererFlip flip = SDL_FLIP_NONE) {
-		SDL_Rect rect;
-		rect.x = x;
-		rect.y = y;
-		rect.w = texture.width;
-		rect.h = texture.height;
-		showTexture(texture, angle, rect, flip);
-	}
+	private:
+		Handle handle;
 
-	/**
-	* texture showed in render screen in position destRect
-	* @param texture the source texture
-	* @param destRect custom rect to draw texture
-	*/
-	void showTexture(const Texture &texture, const SDL_Rect &destRect) {
-		SDL_RenderCopy(Core::renderer, texture.underneathTexture, nullptr, &destRect);
-	}
+		explicit Task(Handle handle) : handle(handle) {
+		}
+	};
 
 	/**
-	* texture showed in render screen in position texture.rect
-	* @param texture the source texture
-	* @param x position x
-	* @param y position y
+	* start a task, it runs until its first co_await now and it is freed when it finishes
+	* @param task the task
 	*/
-	void showTexture(const Texture &texture, int x, int y) {
-		SDL_Rect rect;
-		rect.x = x;
-		rect.y = y;
-		rect.w = texture.width;
-		rect.h = texture.height;
-		showTexture(texture, rect);
+	void startTask(Task &&task) {
+		Task::Handle handle = task.release();
+		if (!handle)
+			return;
+		handle.promise().detached = true;
+		handle.resume();
 	}
 
 	/**
-	* create a texture from a font for a special string with specific color whcih can be drawed in render window
-	* @param font font which is loaded
-	* @param text text that convert to texture
-	* @param r red color
-	* @param g green color
-	* @param b blue color
-	* @return texture which created with that font and text
+	* wait in a task until next frame: co_await SBDL::nextFrame();
 	*/
-	Texture createFontTexture(Font *font, const std::string &text, Uint8 r, Uint8 g, Uint8 b) {
-		SDL_Color color;
-		color.r = r;
-		color.g = g;
-		color.b = b;
-		SDL_Surface *temp = TTF_RenderText_Solid(font, text.c_str(), color);
+	struct nextFrame {
+		bool await_ready() {
+			return false;
+		}
 
-		Texture newTexture;
-		newTexture.underneathTexture = SDL_CreateTextureFromSurface(Core::renderer, temp);
-		newTexture.width = temp->w;
-		newTexture.height = temp->h;
+		void await_suspend(std::coroutine_handle<> task) {
+			Core::frameWaiters.push_back(task);
+		}
 
-		SDL_FreeSurface(temp);
-		return newTexture;
-	}
+		void await_resume() {
+		}
+	};
 
 	/**
-	* check intersection of two SDL_Rect
-	* @param firstRect first rectangle
-	* @param secondRect second rectangle
-	* @return true if has intersection
+	* wait in a task for some seconds: co_await SBDL::seconds(2);
+	* the task is resumed at start of the first frame after the time
 	*/
-	bool hasIntersectionRect(const SDL_Rect &firstRect, const SDL_Rect &secondRect) {
-		return SDL_HasIntersection(&firstRect, &secondRect) == SDL_TRUE;
-	}
+	struct seconds {
+		double duration;
 
-	/**
-	* Draw rectangle on renderer screen.
-	* @param rect rectangle position
-	* @param r red color
-	* @param g green color
-	* @param b blue color
-	* @param alpha transparency
-	*/
-	void drawRectangle(const SDL_Rect &rect, Uint8 r, Uint8 g, Uint8 b, Uint8 alpha = 255) {
-		Uint8 defaults[4];
-		SDL_GetRenderDrawColor(Core::renderer, &defaults[0], &defaults[1], &defaults[2], &defaults[3]);
-		SDL_SetRenderDrawColor(Core::renderer, r, g, b, alpha);
-		SDL_RenderFillRect(Core::renderer, &rect);
-		SDL_SetRenderDrawColor(Core::renderer, defaults[0], defaults[1], defaults[2], defaults[3]);
-	}
+		explicit seconds(double duration) : duration(duration) {
+		}
 
-	/**
-	* Check if a point is inside a Rect
-	* @param x
-	* @param y
-	* @param rect the rectangle to check with
-	* @return true if point is inside the rectangle
-	*/
-	bool pointInRect(int x, int y, const SDL_Rect &rect) {
-		SDL_Point point;
-		point.x = x;
-		point.y = y;
-		return SDL_PointInRect(&point, &rect) == SDL_TRUE;
-	}
+		bool await_ready() {
+			return duration <= 0;
+		}
 
-	/**
-	* Check if mouse is inside a rect
-	* @param rect check when mouse is inside this rectangle
-	* @return true if mouse is inside the rectangle
-	*/
-	bool mouseInRect(const SDL_Rect &rect) {
-		return pointInRect(Mouse.x, Mouse.y, rect);
-	}
+		void await_suspend(std::coroutine_handle<> task) {
+			// suspended tasks wait in the timer wheel, so they cost nothing until their time
+			Core::timeTimers.add(SDL_GetTicks(), Uint32(duration * 1000 + 0.5), 0, [task]() { task.resume(); });
+		}
+
+		void await_resume() {
+		}
+	};
+#endif
 }
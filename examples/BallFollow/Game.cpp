@@ -13,7 +13,7 @@ int main(int argc, char *argv[])
 	Texture blue = SBDL::loadTexture("assets/Blue.png");
 	Texture red = SBDL::loadTexture("assets/Red.png");
 	Texture play_button = SBDL::loadTexture("assets/Play.png");
-	Texture font_texture, win_lose_texture;
+	SBDL::UniqueTexture font_texture, win_lose_texture;
 	Sound *sound = SBDL::loadSound("assets/die.wav");
 	Music *music = SBDL::loadMusic("assets/music.wav");
 	Font *font = SBDL::loadFont("assets/times.ttf", 20);
@@ -23,20 +23,23 @@ int main(int argc, char *argv[])
 	int xr_default = windowWidth - 10, yr_default = windowHeight - 10, xr = xr_default, yr = yr_default, default_enemy_speed = 5, enemy_speed = default_enemy_speed;
 	bool lose = false;
 	int i = 0;
-	int interval = 1000, angle = 0;
+	int angle = 0;
 	int score = 0;
+	// one point for every 34 frames which the player survives
+	SBDL::addFrameTimer(34, [&]() {
+		if (!lose)
+			score++;
+	}, true);
 
 	while (SBDL::isRunning()) {
 		SBDL::updateEvents();
 		SBDL::clearRenderScreen();
 
-		interval -= 30;
 		if (lose) {
 			SBDL::showTexture(blue, x, y);
 			SBDL::showTexture(red, xr, yr);
-			SBDL::freeTexture(win_lose_texture);
-			win_lose_texture = SBDL::createFontTexture(font, "You Lose! Your Score: " + to_string(score), 0, 0, 0);
-			SBDL::showTexture(win_lose_texture, (windowWidth / 2) - (win_lose_texture.width / 2), (windowHeight / 2) - (win_lose_texture.height / 2));
+			win_lose_texture = SBDL::UniqueTexture(SBDL::createFontTexture(font, "You Lose! Your Score: " + to_string(score), 0, 0, 0));
+			SBDL::showTexture(win_lose_texture, (windowWidth / 2) - (win_lose_texture->width / 2), (windowHeight / 2) - (win_lose_texture->height / 2));
 			SDL_Rect play_rect = { (windowWidth / 2) - (play_button.width / 2), (windowHeight / 2) + (play_button.height / 2) + 10 , play_button.width, play_button.height };
 			SBDL::showTexture(play_button, play_rect);
 			if (SBDL::mouseInRect(play_rect) && SBDL::Mouse.clicked()) {
@@ -49,13 +52,8 @@ int main(int argc, char *argv[])
 			}
 		}
 		else {
-			if (interval < 0) {
-				score++;
-				interval = 1000;
-			}
-			SBDL::freeTexture(font_texture);
-			font_texture = SBDL::createFontTexture(font, "score: " + to_string(score), 0, 0, 0);
-			SBDL::showTexture(font_texture, windowWidth - font_texture.width - 10, 10);
+			font_texture = SBDL::UniqueTexture(SBDL::createFontTexture(font, "score: " + to_string(score), 0, 0, 0));
+			SBDL::showTexture(font_texture, windowWidth - font_texture->width - 10, 10);
 
 			enemy_speed = default_enemy_speed + score / 2;
 			speed = default_speed + score / 4;
@@ -62,16 +62,14 @@ int main()
 void load()
 {
 	srand(time(NULL));
-	blockTextures[0] = SBDL::loadTexture("assets/block0.png");
-	blockTextures[1] = SBDL::loadTexture("assets/block1.png");
-	blockTextures[2] = SBDL::loadTexture("assets/block2.png");
-	blockTextures[3] = SBDL::loadTexture("assets/block3.png");
-	blockTextures[4] = SBDL::loadTexture("assets/block4.png");
-	blockTextures[5] = SBDL::loadTexture("assets/block5.png");
-	plate.texture = SBDL::loadTexture("assets/plate.png");
+	SBDL::loadManifest("assets/assets.manifest");
+	SBDL::loadScene("game");
+	for (int i = 0; i < 6; ++i)
+		blockTextures[i] = SBDL::getTexture("block" + to_string(i));
+	plate.texture = SBDL::getTexture("plate");
 	plate.pos = { (814 - 84) / 2,600 - 18,84,18 };
-	stone = SBDL::loadTexture("assets/stone.png");
-	ball.texture = SBDL::loadTexture("assets/ball.png");
+	stone = SBDL::getTexture("stone");
+	ball.texture = SBDL::getTexture("ball");
 	ball.pos = { (814 - 26) / 2,300,26,26 };
 	ball.vx = rand() % 3 - 1;
 	if (ball.vx == 0) ball.vx = 1;
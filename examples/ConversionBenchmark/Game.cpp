@@ -0,0 +1,59 @@
+#include <iostream>
+#include "SBDL.h"
+
+using namespace std;
+
+// loads a large color-keyed paletted image with SBDL and with the plain SDL path and reports the average load time
+int main(int argc, char *argv[])
+{
+	const int size = 2048;
+	const int runs = 10;
+	const char *path = "paletted.bmp";
+	SBDL::InitEngine("ConversionBenchmark", 500, 500);
+
+	// 256 color image with magenta (index 0) as color key
+	SDL_Surface *image = SDL_CreateRGBSurfaceWithFormat(0, size, size, 8, SDL_PIXELFORMAT_INDEX8);
+	SDL_Color colors[256];
+	for (int i = 0; i < 256; i++)
+		colors[i] = { Uint8(i), Uint8(255 - i), Uint8(i * 7), 255 };
+	colors[0] = { 255, 0, 255, 255 };
+	SDL_SetPaletteColors(image->format->palette, colors, 0, 256);
+	for (int y = 0; y < size; y++) {
+		Uint8 *row = (Uint8 *)image->pixels + size_t(y) * image->pitch;
+		for (int x = 0; x < size; x++)
+			row[x] = Uint8((x / 16 + y / 16) % 4 == 0 ? 0 : (x ^ y) & 0xFF);
+	}
+	SDL_SaveBMP(image, path);
+	SDL_FreeSurface(image);
+
+	double frequency = double(SDL_GetPerformanceFrequency());
+	Uint64 sdlTicks = 0, sbdlTicks = 0;
+	for (int i = 0; i < runs; i++) {
+		// conversion of SDL happens when texture is created (and may be deferred until it is drawn)
+		Uint64 start = SDL_GetPerformanceCounter();
+		SDL_Surface *surface = IMG_Load(path);
+		SDL_SetColorKey(surface, SDL_TRUE, SDL_MapRGB(surface->format, 255, 0, 255));
+		SDL_Texture *texture = SDL_CreateTextureFromSurface(SBDL::Core::renderer, surface);
+		SDL_FreeSurface(surface);
+		SBDL::clearRenderScreen();
+		SDL_RenderCopy(SBDL::Core::renderer, texture, nullptr, nullptr);
+		SBDL::updateRenderScreen();
+		sdlTicks += SDL_GetPerformanceCounter() - start;
+		SDL_DestroyTexture(texture);
+
+		start = SDL_GetPerformanceCounter();
+		Texture converted = SBDL::loadTexture(path, 255, 0, 255);
+		SBDL::clearRenderScreen();
+		SBDL::showTexture(converted, { 0, 0, 500, 500 });
+		SBDL::updateRenderScreen();
+		sbdlTicks += SDL_GetPerformanceCounter() - start;
+		SBDL::freeTexture(converted);
+	}
+
+	cout << size << "x" << size << " paletted image, " << runs << " runs" << endl;
+	cout << "SDL color key: " << sdlTicks * 1000.0 / frequency / runs << " ms per load" << endl;
+	cout << "SBDL conversion: " << sbdlTicks * 1000.0 / frequency / runs << " ms per load" << endl;
+
+	remove(path);
+	return 0;
+}
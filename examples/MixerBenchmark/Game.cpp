@@ -0,0 +1,59 @@
+#include <iostream>
+#include <vector>
+#include <math.h>
+#include "SBDL.h"
+
+using namespace std;
+
+// mixes many voices with the software mixer on this thread and reports how many voices are mixed per millisecond of CPU
+int main(int argc, char *argv[])
+{
+	const int frames = 1024;
+	const int buffers = 200;
+	const int counts[] = { 64, 128, 256, 512, 1024 };
+	SBDL::InitEngine("MixerBenchmark", 200, 100);
+	if (!SBDL::initMixer(1024)) {
+		cout << "audio device doesn't use 16 bits stereo samples" << endl;
+		return 1;
+	}
+	int frequency, channels;
+	Uint16 format;
+	Mix_QuerySpec(&frequency, &format, &channels);
+
+	// the audio thread stops mixing, buffers are mixed here instead, so only the mixer is measured
+	Mix_SetPostMix(nullptr, nullptr);
+
+	// one second of a stereo tone
+	vector<Sint16> tone(2 * frequency);
+	for (int i = 0; i < frequency; i++)
+		tone[2 * i] = tone[2 * i + 1] = Sint16(8000 * sin(2 * M_PI * 440 * i / frequency));
+	Sound *sound = Mix_QuickLoad_RAW((Uint8 *)tone.data(), Uint32(tone.size() * sizeof(Sint16)));
+
+	vector<Sint16> stream(2 * frames);
+	double frequencyOfCounter = double(SDL_GetPerformanceFrequency());
+	double bufferMilliseconds = 1000.0 * frames / frequency;
+	for (int count : counts) {
+		SBDL::stopAllMixerSounds();
+		// different pitches, so voices are resampled
+		for (int i = 0; i < count; i++)
+			SBDL::playMixerSound(sound, SBDL::AudioBus::Sfx, 0.01f, (i % 21 - 10) / 10.0f, 0.5f + (i % 16) / 10.0f, -1);
+		SBDL::Core::postMix(nullptr, (Uint8 *)stream.data(), int(stream.size() * sizeof(Sint16)));
+
+		Uint64 start = SDL_GetPerformanceCounter();
+		for (int i = 0; i < buffers; i++) {
+			fill(stream.begin(), stream.end(), Sint16(0));
+			SBDL::Core::postMix(nullptr, (Uint8 *)stream.data(), int(stream.size() * sizeof(Sint16)));
+		}
+		double milliseconds = (SDL_GetPerformanceCounter() - start) * 1000.0 / frequencyOfCounter / buffers;
+
+		// milliseconds of voices which are mixed in one millisecond of CPU time
+
+		cout << count << " voices: " << milliseconds << " ms per " << bufferMilliseconds << " ms buffer, "
+			<< count * bufferMilliseconds / milliseconds << " voices per ms of CPU" << endl;
+	}
+
+	SBDL::stopAllMixerSounds();
+	SBDL::Core::postMix(nullptr, (Uint8 *)stream.data(), int(stream.size() * sizeof(Sint16)));
+	Mix_FreeChunk(sound);
+	return 0;
+}
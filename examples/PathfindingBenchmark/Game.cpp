@@ -0,0 +1,79 @@
+#include <iostream>
+#include <vector>
+#include <stdlib.h>
+#include "SBDL.h"
+
+using namespace std;
+
+// 1000 agents find a way to one goal on a 512x512 grid with A*, jump point search and a flow field
+int main(int argc, char *argv[])
+{
+	const int size = 512;
+	const int blocks = 3000;
+	const int agentCount = 1000;
+	srand(1);
+
+	// random walls like blocks of a level
+	SBDL::PathGrid grid(size, size);
+	for (int i = 0; i < blocks; i++)
+		grid.blockRect({ rand() % size, rand() % size, 1 + rand() % 12, 1 + rand() % 12 }, 1);
+
+	const int goalX = size / 2, goalY = size / 2;
+	grid.setBlocked(goalX, goalY, false);
+	vector<SDL_Point> agents;
+	while (int(agents.size()) < agentCount) {
+		SDL_Point agent = { rand() % size, rand() % size };
+		if (grid.isWalkable(agent.x, agent.y))
+			agents.push_back(agent);
+	}
+
+	double frequency = double(SDL_GetPerformanceFrequency());
+	vector<SDL_Point> path;
+	long long expanded = 0;
+	int found = 0;
+	Uint64 start = SDL_GetPerformanceCounter();
+	for (const SDL_Point &agent : agents) {
+		found += grid.findPath(agent.x, agent.y, goalX, goalY, path);
+		expanded += grid.getExpandedCells();
+	}
+	double milliseconds = (SDL_GetPerformanceCounter() - start) * 1000.0 / frequency;
+	cout << "A*: " << milliseconds << " ms for " << agentCount << " agents (" << milliseconds / agentCount
+		<< " ms per agent, " << expanded / agentCount << " cells expanded per agent, " << found << " paths)" << endl;
+
+	expanded = 0;
+	found = 0;
+	start = SDL_GetPerformanceCounter();
+	for (const SDL_Point &agent : agents) {
+		found += grid.findJumpPath(agent.x, agent.y, goalX, goalY, path);
+		expanded += grid.getExpandedCells();
+	}
+	milliseconds = (SDL_GetPerformanceCounter() - start) * 1000.0 / frequency;
+	cout << "jump point search: " << milliseconds << " ms for " << agentCount << " agents (" << milliseconds / agentCount
+		<< " ms per agent, " << expanded / agentCount << " cells expanded per agent, " << found << " paths)" << endl;
+
+	SBDL::FlowField field(grid);
+	start = SDL_GetPerformanceCounter();
+	field.setGoal(goalX, goalY);
+	field.update();
+	milliseconds = (SDL_GetPerformanceCounter() - start) * 1000.0 / frequency;
+	found = 0;
+	start = SDL_GetPerformanceCounter();
+	for (const SDL_Point &agent : agents) {
+		int dx, dy;
+		found += field.getDirection(agent.x, agent.y, dx, dy);
+	}
+	double directions = (SDL_GetPerformanceCounter() - start) * 1000.0 / frequency;
+	cout << "flow field: " << milliseconds << " ms to compute, " << directions << " ms for directions of "
+		<< agentCount << " agents (" << found << " can move)" << endl;
+
+	// the same field in slices of 16384 cells per frame
+	int frames = 1;
+	start = SDL_GetPerformanceCounter();
+	field.setGoal(goalX, goalY);
+	while (!field.update(16384))
+		frames++;
+	milliseconds = (SDL_GetPerformanceCounter() - start) * 1000.0 / frequency;
+	cout << "flow field in slices: " << milliseconds << " ms in " << frames << " frames ("
+		<< milliseconds / frames << " ms per frame)" << endl;
+	return 0;
+}
@@ -0,0 +1,46 @@
+#include <iostream>
+#include "SBDL.h"
+
+using namespace std;
+
+// fills a 1024x1024 streaming texture every frame and reports the average cost of the upload
+int main(int argc, char *argv[])
+{
+	const int size = 1024;
+	const int frames = 600;
+	SBDL::InitEngine("StreamingBenchmark", size, size);
+
+	Texture canvas = SBDL::createStreamingTexture(size, size);
+
+	Uint64 fillTicks = 0, uploadTicks = 0;
+	int frame = 0;
+	while (SBDL::isRunning() && frame < frames) {
+		SBDL::updateEvents();
+		SBDL::clearRenderScreen();
+
+		Uint64 start = SDL_GetPerformanceCounter();
+		SBDL::PixelSpan span = SBDL::lockTexture(canvas);
+		for (int y = 0; y < span.height; y++)
+			for (int x = 0; x < span.width; x++)
+				span.at(x, y) = 0xFF000000u | Uint32((x + frame) & 0xFF) << 16 | Uint32((y + frame) & 0xFF) << 8 | Uint32((x ^ y) & 0xFF);
+		Uint64 filled = SDL_GetPerformanceCounter();
+		SBDL::unlockTexture(canvas);
+		Uint64 uploaded = SDL_GetPerformanceCounter();
+		fillTicks += filled - start;
+		uploadTicks += uploaded - filled;
+
+		SBDL::showTexture(canvas, 0, 0);
+		SBDL::updateRenderScreen();
+		frame++;
+	}
+
+	double frequency = double(SDL_GetPerformanceFrequency());
+	if (frame > 0) {
+		cout << "frames: " << frame << endl;
+		cout << "fill: " << fillTicks * 1000.0 / frequency / frame << " ms per frame" << endl;
+		cout << "upload: " << uploadTicks * 1000.0 / frequency / frame << " ms per frame" << endl;
+	}
+
+	SBDL::freeTexture(canvas);
+	return 0;
+}